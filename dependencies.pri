@@ -1,4 +1,5 @@
 QT += gui widgets
+DEPENDENCIES += general_configurator_core
 DEPENDENCIES += tp_utils_filesystem
 DEPENDENCIES += tp_qt_widgets
 
@@ -0,0 +1,2 @@
+DEPENDENCIES += general_configurator_core
+DEPENDENCIES += tp_utils_filesystem
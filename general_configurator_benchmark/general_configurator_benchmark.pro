@@ -0,0 +1,3 @@
+include(vars.pri)
+include(dependencies.pri)
+include(../../tp_build/qmake/project_qt.pri)
@@ -0,0 +1,109 @@
+#include "general_configurator_core/PRIParser.h"
+
+#include "tp_utils_filesystem/Globals.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+using namespace general_configurator;
+
+namespace
+{
+
+//##################################################################################################
+//! Build a .pri file of roughly size bytes that uses scopes, blocks, continuations and comments.
+std::string generatePRI(size_t size)
+{
+  std::string data;
+  data.reserve(size + 1024);
+
+  for(size_t i=0; data.size()<size; i++)
+  {
+    std::string n = std::to_string(i);
+
+    data += "# Module " + n + "\n";
+    data += "DEPENDENCIES += tp_module_" + n + " \\\n";
+    data += "                tp_other_" + n + " \\\n";
+    data += "                \"quoted value " + n + "\"\n";
+    data += "INCLUDEPATHS += $$PWD/inc_" + n + "\n";
+    data += "CONFIG_" + n + " *= c++17 warn_on\n";
+    data += "linux:!android: LIBS += -lmodule_" + n + "\n";
+    data += "win32:CONFIG(release, debug|release) {\n";
+    data += "  DEFINES += MODULE_" + n + "_RELEASE\n";
+    data += "} else {\n";
+    data += "  DEFINES -= MODULE_" + n + "_RELEASE\n";
+    data += "  message(Building module " + n + ")\n";
+    data += "}\n";
+  }
+
+  return data;
+}
+
+//##################################################################################################
+double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//##################################################################################################
+void printRate(const std::string& name, size_t bytes, double seconds, size_t count)
+{
+  double mb = double(bytes) / (1024.0*1024.0);
+  std::cout << name << ": " << seconds*1000.0 << "ms, " << mb/seconds << " MB/s, "
+            << count << " values" << std::endl;
+}
+
+}
+
+//##################################################################################################
+//! Usage: general_configurator_benchmark [<size in MB>] [<iterations>]
+int main(int argc, char* argv[])
+{
+  tp_utils_filesystem::init();
+
+  size_t sizeMB = (argc>1)?size_t(std::atoi(argv[1])):64;
+  size_t iterations = (argc>2)?size_t(std::atoi(argv[2])):3;
+  if(sizeMB==0 || iterations==0)
+  {
+    std::cerr << "Usage: general_configurator_benchmark [<size in MB>] [<iterations>]" << std::endl;
+    return 2;
+  }
+
+  std::string data = generatePRI(sizeMB*1024*1024);
+  std::cout << "Generated " << data.size() << " bytes of .pri" << std::endl;
+
+  for(size_t i=0; i<iterations; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t count=0;
+    parsePRI(data, [&](const PRIStatement& statement)
+    {
+      count += statement.values.size();
+    });
+    printRate("parsePRI", data.size(), elapsedSeconds(start), count);
+  }
+
+  // evaluatePRIFile reads from disk, so this also includes reading the file and expanding values.
+  std::string path = tp_utils::pathAppend(tp_utils::directoryName(argv[0]), "general_configurator_benchmark.pri");
+  if(!tp_utils::writeTextFile(path, data))
+  {
+    std::cerr << "Failed to write: " << path << std::endl;
+    return 1;
+  }
+
+  for(size_t i=0; i<iterations; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t count=0;
+    for(const auto& variable : evaluatePRIFile(path))
+      count += variable.second.size();
+    printRate("evaluatePRIFile", data.size(), elapsedSeconds(start), count);
+  }
+
+  std::remove(path.c_str());
+  return 0;
+}
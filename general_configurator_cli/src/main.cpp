@@ -0,0 +1,44 @@
+#include "general_configurator_core/CommandLine.h"
+
+#include "tp_utils_filesystem/Globals.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <cstdlib>
+
+using namespace general_configurator;
+
+namespace
+{
+
+//##################################################################################################
+//! The directory that QStandardPaths::AppDataLocation gives the GUI, so both share one cache.
+std::string defaultCacheDirectory()
+{
+  auto env = [](const char* name)
+  {
+    const char* value = std::getenv(name);
+    return value?std::string(value):std::string();
+  };
+
+#if defined(_WIN32)
+  std::string base = env("APPDATA");
+#elif defined(__APPLE__)
+  std::string base = tp_utils::pathAppend(env("HOME"), "Library/Application Support");
+#else
+  std::string base = env("XDG_DATA_HOME");
+  if(base.empty())
+    base = tp_utils::pathAppend(env("HOME"), ".local/share");
+#endif
+
+  return tp_utils::pathAppend(tp_utils::pathAppend(base, "Tdp"), "Configurator");
+}
+
+}
+
+//##################################################################################################
+int main(int argc, char* argv[])
+{
+  tp_utils_filesystem::init();
+  return runCommandLine(argc, argv, defaultCacheDirectory());
+}
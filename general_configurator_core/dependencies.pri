@@ -0,0 +1,5 @@
+DEPENDENCIES += tp_utils
+DEPENDENCIES += tp_utils_filesystem
+DEPENDENCIES += lib_json
+
+INCLUDEPATHS += general_configurator/general_configurator_core/inc/
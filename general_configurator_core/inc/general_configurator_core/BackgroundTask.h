@@ -0,0 +1,70 @@
+#ifndef general_configurator_core_BackgroundTask_h
+#define general_configurator_core_BackgroundTask_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <atomic>
+#include <functional>
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! A snapshot of the progress of a BackgroundTask.
+struct BackgroundTaskState
+{
+  float progress{0.0f};
+  std::string description; //!< The description of the most recent step.
+  bool finished{false};
+  bool success{false};     //!< The return value of the closure, valid once finished.
+  bool cancelled{false};   //!< Set as soon as cancel is called, the task may still be running.
+  std::string error;       //!< The errors added to the progress, valid once finished.
+};
+
+//##################################################################################################
+//! Run an operation that reports to a tp_utils::Progress on its own thread.
+/*!
+The progress is owned by the worker thread, each time it polls the worker publishes a snapshot that
+other threads can read with state(). This allows a UI to stay responsive and show progress without
+the operation re-entering the event loop.
+
+The closure must not touch anything that the owning thread may change while the task is running.
+Results should be handed back through variables that are only read once the task has finished.
+
+The closure is also passed the cancel flag, code that blocks without polling the progress, such as
+waiting for a process, should check it directly.
+*/
+class BackgroundTask
+{
+  TP_DQ;
+public:
+  //################################################################################################
+  //! Start running closure on a new thread.
+  BackgroundTask(const std::string& message,
+                 const std::function<bool(tp_utils::Progress*, const std::atomic<bool>& cancel)>& closure);
+
+  //################################################################################################
+  //! Cancels the task and waits for it to finish.
+  ~BackgroundTask();
+
+  //################################################################################################
+  //! Ask the task to stop, this sets the cancel flag and stops the progress the next time it polls.
+  void cancel();
+
+  //################################################################################################
+  //! Returns a copy of the current state, this can be called from any thread.
+  BackgroundTaskState state() const;
+
+  //################################################################################################
+  //! Block until the closure has returned.
+  void wait();
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef general_configurator_core_BatchGenerate_h
+#define general_configurator_core_BatchGenerate_h
+
+#include "general_configurator_core/Generate.h"
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+class Cache;
+
+//##################################################################################################
+//! One app to generate, the equivalent of filling in the GUI and pressing Generate.
+struct BatchJob
+{
+  tp_utils::StringID templateModule;
+  std::string rootPath;
+  std::string prefix;
+  std::string suffix;
+  std::unordered_set<tp_utils::StringID> libraries; //!< Dependencies are added automatically.
+
+  //################################################################################################
+  nlohmann::json saveState() const;
+
+  //################################################################################################
+  void loadState(const nlohmann::json& j);
+};
+
+//##################################################################################################
+struct BatchJobResult
+{
+  bool success{false};
+  std::string appPath;
+  size_t dependencyCount{0};
+  int64_t elapsedMS{0};
+  std::string error;
+
+  //################################################################################################
+  nlohmann::json saveState() const;
+};
+
+//##################################################################################################
+struct BatchParams
+{
+  size_t maxParallelJobs{4}; //!< The number of apps to generate at the same time.
+  GenerateParams generateParams;
+};
+
+//##################################################################################################
+//! Read a batch manifest, a JSON file with a "jobs" array or just the array of jobs.
+/*!
+Each job looks like this:
+\code
+{
+  "template": "tp_example_app",
+  "rootPath": "/home/user/projects",
+  "prefix": "tp",
+  "suffix": "demo",
+  "libraries": ["tp_utils", "tp_math_utils"]
+}
+\endcode
+*/
+bool loadBatchManifest(const std::string& path, std::vector<BatchJob>& jobs, std::string& error);
+
+//##################################################################################################
+//! Generate several apps concurrently.
+/*!
+All of the jobs are resolved against the cache as it is when this is called, the cache must not be
+modified until this returns. Jobs that fail are reported in their result and don't stop the others.
+
+\param results One result for each job, in the same order as the jobs.
+\return true if every job succeeded.
+*/
+bool generateBatch(const Cache& cache,
+                   const std::vector<BatchJob>& jobs,
+                   const BatchParams& params,
+                   tp_utils::Progress* progress,
+                   std::vector<BatchJobResult>& results);
+
+//##################################################################################################
+//! A JSON report of the jobs and their results.
+nlohmann::json batchReport(const std::vector<BatchJob>& jobs, const std::vector<BatchJobResult>& results);
+
+}
+
+#endif
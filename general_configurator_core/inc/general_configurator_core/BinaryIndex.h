@@ -0,0 +1,32 @@
+#ifndef general_configurator_core_BinaryIndex_h
+#define general_configurator_core_BinaryIndex_h
+
+#include "general_configurator_core/Globals.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! Read a binary cache index written by writeBinaryIndex.
+/*!
+The file is memory mapped read-only and validated against the version and checksum in its header
+before anything is read from it.
+
+\param path The path of the binary index.
+\param sourceRepos Populated with the source repos.
+\param modules Populated with the modules.
+\return true if the index was read, false if it was missing, from another version or corrupt.
+*/
+bool readBinaryIndex(const std::string& path,
+                     std::vector<std::string>& sourceRepos,
+                     std::vector<Module>& modules);
+
+//##################################################################################################
+//! Write a binary cache index, see readBinaryIndex.
+bool writeBinaryIndex(const std::string& path,
+                      const std::vector<std::string>& sourceRepos,
+                      const std::vector<Module>& modules);
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef general_configurator_core_Cache_h
+#define general_configurator_core_Cache_h
+
+#include "general_configurator_core/Globals.h"
+
+#include "tp_utils/CallbackCollection.h"
+
+namespace general_configurator
+{
+class ModuleGraph;
+class ModuleSearchIndex;
+
+//##################################################################################################
+class Cache
+{
+  TP_DQ;
+public:
+  //################################################################################################
+  Cache(const std::string& cacheDirectory);
+
+  //################################################################################################
+  ~Cache();
+
+  //################################################################################################
+  //! Empty if the index loaded, or was rebuilt because it could not be read and then saved.
+  const std::string& loadError() const;
+
+  //################################################################################################
+  const std::string& cacheDirectory() const;
+
+  //################################################################################################
+  //! The directory that updateCache checks the module repos out into.
+  std::string reposDirectory() const;
+
+  //################################################################################################
+  //! The binary index that the source repos and modules are saved to.
+  std::string indexPath() const;
+
+  //################################################################################################
+  //! Where exportJSON writes by default, this is only read back by importJSON.
+  std::string exportPath() const;
+
+  //################################################################################################
+  //! \return false if the index could not be written, the source repos are still updated.
+  bool setSourceRepos(const std::vector<std::string>& sourceRepos);
+
+  //################################################################################################
+  const std::vector<std::string>& sourceRepos() const;
+
+  //################################################################################################
+  //! \return false if the index could not be written, the modules are still updated.
+  bool setModules(const std::vector<Module>& modules);
+
+  //################################################################################################
+  const std::vector<Module>& modules() const;
+
+  //################################################################################################
+  //! Write the source repos and modules as JSON, the cache itself is kept in a binary index.
+  /*!
+  \param path Where to write the JSON, if empty exportPath() is used.
+  \return true if the file was written.
+  */
+  bool exportJSON(const std::string& path=std::string()) const;
+
+  //################################################################################################
+  //! Replace the source repos and modules with JSON written by exportJSON and save the index.
+  /*!
+  \param path The JSON to read.
+  \return false if the file could not be read or the index could not be written.
+  */
+  bool importJSON(const std::string& path);
+
+  //################################################################################################
+  //! Returns a copy of the module or an empty module if it is not in the cache.
+  Module module(const tp_utils::StringID& name) const;
+
+  //################################################################################################
+  //! Returns the module or nullptr if it is not in the cache, valid until the modules are changed.
+  const Module* findModule(const tp_utils::StringID& name) const;
+
+  //################################################################################################
+  //! The dependency graph of the modules, ids match the index of the module in modules().
+  const ModuleGraph& graph() const;
+
+  //################################################################################################
+  //! Name search over the modules, rebuilt with the graph whenever the modules change.
+  const ModuleSearchIndex& searchIndex() const;
+
+  //################################################################################################
+  bool isDependency(const tp_utils::StringID& name, const tp_utils::StringID& of) const;
+
+  //################################################################################################
+  //! Sort modules so that dependencies come first and modules are grouped by prefix.
+  /*!
+  Modules that depend on each other in a cycle can't be sorted, they are moved to the end in their
+  original order and their names are written to cycle.
+
+  \param modules The modules to sort, these don't need to be the modules in the cache.
+  \param cycle Optional output for the names of the modules that form dependency cycles.
+  \return true if all modules were sorted, false if there was a dependency cycle.
+  */
+  bool sortModules(std::vector<Module>& modules, std::vector<tp_utils::StringID>* cycle=nullptr) const;
+
+  //################################################################################################
+  //! Returns the names and all of their direct and indirect dependencies.
+  std::unordered_set<tp_utils::StringID> dependencyClosure(const std::unordered_set<tp_utils::StringID>& names) const;
+
+  //################################################################################################
+  //! Returns the modules that depend on name in cache order.
+  /*!
+  \param name The module to find the dependents of.
+  \param transitive If true indirect dependents are also returned, otherwise only direct ones.
+  */
+  std::vector<tp_utils::StringID> dependents(const tp_utils::StringID& name, bool transitive) const;
+
+  //################################################################################################
+  std::vector<tp_utils::StringID> sortDependencies(const std::unordered_set<tp_utils::StringID>& dependencies) const;
+
+  //################################################################################################
+  tp_utils::CallbackCollection<void()> changed;
+};
+
+}
+
+#endif
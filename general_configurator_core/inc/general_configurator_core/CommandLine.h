@@ -0,0 +1,26 @@
+#ifndef general_configurator_core_CommandLine_h
+#define general_configurator_core_CommandLine_h
+
+#include "general_configurator_core/Globals.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! Returns true if the arguments name a subcommand, otherwise the GUI should be started.
+bool isCommandLine(int argc, char* argv[]);
+
+//##################################################################################################
+//! Run a subcommand without a GUI.
+/*!
+The result of the subcommand is written to stdout as JSON, progress and errors go to stderr. See
+the usage printed by "general_configurator help" for the subcommands and their options.
+
+\param defaultCacheDirectory The cache to use unless --cache is passed.
+\return The exit code, 0 on success, 1 if the subcommand failed, 2 for bad arguments.
+*/
+int runCommandLine(int argc, char* argv[], const std::string& defaultCacheDirectory);
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef general_configurator_core_FetchSubmodules_h
+#define general_configurator_core_FetchSubmodules_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <unordered_map>
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct FetchParams
+{
+  size_t maxParallelFetches{4}; //!< The number of repos to fetch at the same time, 0 for one per hardware thread.
+  bool continueOnError{false};  //!< Keep fetching the other repos if one fails, the fetch still fails.
+  CloneMode cloneMode{CloneMode::Full};
+  bool recursive{true};         //!< Follow the submodules.pri files of the submodules as well.
+  int64_t timeoutMS{0};         //!< Kill git commands that run for longer than this, 0 for no limit.
+
+  //! If set, full clones of the missing repos found in this directory are cloned locally instead
+  //! of from the network, origin still points at the URL of the repo.
+  std::string localReposDirectory;
+
+  //! Known URLs by module name, missing modules that are not listed here get the URL prefix of the
+  //! module whose submodules.pri referenced them.
+  std::unordered_map<std::string, std::string> urls;
+};
+
+//##################################################################################################
+struct FetchRepo
+{
+  std::string name;
+  std::string url;    //!< The URL to clone from if the repo does not exist yet.
+  bool exists{false}; //!< If true the repo is fast forwarded instead of cloned.
+};
+
+//##################################################################################################
+//! Clone repos that are not in the directory yet and fast forward the ones that are, concurrently.
+/*!
+The git commands of all of the repos are run by runProcesses on the calling thread.
+*/
+bool fetchRepos(const std::string& directory,
+                const std::vector<FetchRepo>& repos,
+                const FetchParams& params,
+                tp_utils::Progress* progress);
+
+//##################################################################################################
+//! Clone everything listed in the submodules.pri files of rootModules.
+/*!
+This replaces running "tpUpdate noupdate" in directory. Modules that already exist in directory are
+not fetched again but their submodules.pri files are still followed. Each wave of missing modules is
+de-duplicated and cloned concurrently.
+
+\param directory The directory that contains the root modules, submodules are cloned next to them.
+\param rootModules The names of the modules to start from.
+\return true if all of the submodules were fetched.
+*/
+bool fetchSubmodules(const std::string& directory,
+                     const std::vector<std::string>& rootModules,
+                     const FetchParams& params,
+                     tp_utils::Progress* progress);
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef general_configurator_core_FileCopy_h
+#define general_configurator_core_FileCopy_h
+
+#include "general_configurator_core/Globals.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct TreeEntry
+{
+  enum class Type
+  {
+    File,
+    Directory,
+    Symlink
+  };
+
+  std::string path; //!< Relative to the directory that was listed.
+  Type type{Type::File};
+  uint32_t mode{0}; //!< Permission bits.
+  size_t size{0};
+};
+
+//##################################################################################################
+//! List everything in a directory tree, parent directories come before their contents.
+/*!
+Symlinks are listed but not followed.
+
+\param directory The directory to list, this is not included in the output.
+\param skip File and directory names to skip at any depth, for example ".git".
+\param entries The entries are appended to this.
+\param error Set to a description of the first failure.
+\return true if the whole tree was listed.
+*/
+bool listTree(const std::string& directory,
+              const std::unordered_set<std::string>& skip,
+              std::vector<TreeEntry>& entries,
+              std::string& error);
+
+//##################################################################################################
+struct CopyTreeStats
+{
+  size_t files{0};       //!< The number of files copied.
+  size_t clonedFiles{0}; //!< Files that share their data with the source through a reflink.
+  size_t bytes{0};       //!< The size of all copied files.
+  int64_t elapsedMS{0};
+};
+
+//##################################################################################################
+//! Copy a directory tree, sharing the file data with the source where the filesystem allows it.
+/*!
+Each file is cloned with a reflink if the filesystem supports it (btrfs, XFS, APFS), otherwise it is
+copied in the kernel with copy_file_range, and as a last resort with read and write. Symlinks are
+recreated and file permissions are kept.
+
+\param from The directory to copy.
+\param to The directory to copy into, this is created if it does not exist.
+\param skip File and directory names to skip at any depth, for example ".git".
+\param error Set to a description of the first failure.
+\param stats Optional output for the number of files and bytes copied.
+\return true if everything was copied.
+*/
+bool copyTree(const std::string& from,
+              const std::string& to,
+              const std::unordered_set<std::string>& skip,
+              std::string& error,
+              CopyTreeStats* stats=nullptr);
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef general_configurator_core_Generate_h
+#define general_configurator_core_Generate_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <atomic>
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+class Cache;
+
+//##################################################################################################
+struct GenerateParams
+{
+  size_t maxParallelFetches{4}; //!< The number of dependencies to fetch at the same time.
+  size_t maxRewriteThreads{0};  //!< Threads used to rewrite the template, 0 for one per hardware thread.
+  bool useTpUpdate{false};      //!< Fetch dependencies with the external tpUpdate instead of fetchSubmodules.
+  bool cloneFromCache{true};    //!< Clone dependencies from the repos in the cache where possible.
+
+  //! Optional, a checkout of the template to copy instead of the one in the cache, see generateBatch.
+  std::string templateSnapshot;
+
+  //! Optional, checked while git and tpUpdate run so that a cancel does not wait for the progress to poll.
+  const std::atomic<bool>* cancel{nullptr};
+};
+
+//##################################################################################################
+//! Returns the checkout of a module in the cache if it can be copied to make a new app.
+/*!
+Only full clones that are at the head recorded in the index can be used.
+
+\param reason Set to why the checkout can't be used when an empty string is returned.
+*/
+std::string usableCacheCheckout(const Cache& cache, const Module& module, std::string& reason);
+
+//##################################################################################################
+bool generateApp(const Cache& cache,
+                 const tp_utils::StringID& templateModuleId,
+                 const std::string& rootPath,
+                 const std::string& modulePrefix,
+                 const std::string& moduleSuffix,
+                 const std::unordered_set<tp_utils::StringID>& selectedLibraries,
+                 const std::unordered_set<tp_utils::StringID>& allDependencies,
+                 tp_utils::Progress* progress,
+                 const GenerateParams& params=GenerateParams());
+
+//##################################################################################################
+std::string generateSubmodules(const Cache& cache,
+                               const std::string& moduleName,
+                               const std::unordered_set<tp_utils::StringID>& allDependencies);
+
+//##################################################################################################
+//! Same as above for dependencies that are already in build order.
+std::string generateSubmodules(const std::string& moduleName,
+                               const std::vector<tp_utils::StringID>& sortedDependencies);
+
+
+}
+
+#endif
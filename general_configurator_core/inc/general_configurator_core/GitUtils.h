@@ -0,0 +1,125 @@
+#ifndef general_configurator_core_GitUtils_h
+#define general_configurator_core_GitUtils_h
+
+#include "general_configurator_core/Globals.h"
+#include "general_configurator_core/Process.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! Returns the directory name that git clone would use for a repo URL.
+std::string repoNameFromURL(const std::string& url);
+
+//##################################################################################################
+//! Returns the git directory of a working tree, following .git files used by worktrees.
+std::string gitDirectory(const std::string& repoPath);
+
+//##################################################################################################
+//! Returns the commit hash that HEAD points to or an empty string if it can't be resolved.
+std::string readGitHead(const std::string& repoPath);
+
+//##################################################################################################
+//! Read a value from the config of a repo without running git.
+/*!
+This reads the repo config and config.worktree, following [include] directives. Like
+"git config --get" the last value wins and an empty string is returned if the key is not set.
+
+\param section The section name, this is not case sensitive.
+\param subsection The subsection name, this is case sensitive, pass an empty string for none.
+\param key The key name, this is not case sensitive.
+*/
+std::string readGitConfigValue(const std::string& repoPath,
+                               const std::string& section,
+                               const std::string& subsection,
+                               const std::string& key);
+
+//##################################################################################################
+//! Returns remote.<remote>.url from the config of a repo.
+std::string readGitRemoteURL(const std::string& repoPath, const std::string& remote="origin");
+
+//##################################################################################################
+//! Returns Metadata for shallow or sparse clones made by GitCommands::clone, otherwise Full.
+CloneMode repoCloneMode(const std::string& repoPath);
+
+//##################################################################################################
+//! The git commands that clone or update one repo, run one after another by runProcesses.
+/*!
+The commands are handed out one at a time so that many repos can be fetched from a single poll loop.
+*/
+class GitCommands
+{
+public:
+  //################################################################################################
+  //! Clone a repo into directory/name.
+  /*!
+  A metadata clone is shallow, blob filtered and only checks out the .pri files in the root of the
+  repo. If that fails, for example because the remote does not support it, a full clone is made.
+
+  \param timeoutMS Limit for each git command, 0 for no limit.
+  */
+  static GitCommands clone(const std::string& directory,
+                           const std::string& url,
+                           const std::string& name,
+                           CloneMode mode,
+                           int64_t timeoutMS=0);
+
+  //################################################################################################
+  //! Clone a repo that is already on this machine into directory/name and point origin at url.
+  /*!
+  Git hardlinks the objects of local clones where it can, so this takes very little time or disk
+  space. Origin is then fetched and the checked out branch fast forwarded, so only the objects that
+  the local repo is missing are downloaded.
+
+  \param localPath The working tree of the repo to clone.
+  \param url The remote URL that the new clone should track.
+  */
+  static GitCommands cloneLocal(const std::string& directory,
+                                const std::string& localPath,
+                                const std::string& name,
+                                const std::string& url,
+                                int64_t timeoutMS=0);
+
+  //################################################################################################
+  //! Fast forward an existing repo, shallow clones are fetched at depth 1 and reset.
+  static GitCommands pull(const std::string& repoPath, int64_t timeoutMS=0);
+
+  //################################################################################################
+  //! Take the result of the previous command, nullptr for the first, and fill in the next one.
+  /*!
+  \param output Receives failures that git could not report itself, for example git not starting.
+  \return false once there is nothing left to run.
+  */
+  bool next(const ProcessResult* previous,
+            ProcessParams& params,
+            const std::function<void(const std::string&)>& output);
+
+  //################################################################################################
+  //! The return code of the last command, 0 on success, -1 if git could not be started.
+  int exitCode() const;
+
+  //################################################################################################
+  //! The mode of the clone that was actually made.
+  CloneMode usedMode() const;
+
+private:
+  struct Command
+  {
+    std::string workingDirectory;
+    std::vector<std::string> arguments;
+  };
+
+  std::vector<Command> m_commands;
+  size_t m_next{0};
+  int64_t m_timeoutMS{0};
+  int m_exitCode{-1};
+  CloneMode m_usedMode{CloneMode::Full};
+
+  //! Run if one of the commands fails, after removing m_fallbackCleanup.
+  std::vector<Command> m_fallback;
+  std::string m_fallbackCleanup;
+};
+
+}
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef general_configurator_Globals_h
-#define general_configurator_Globals_h
+#ifndef general_configurator_core_Globals_h
+#define general_configurator_core_Globals_h
 
 #include "tp_utils/StringID.h"
 
@@ -7,12 +7,46 @@
 
 #include <unordered_set>
 
+//##################################################################################################
+//! The core of the configurator, shared by the GUI and the command line.
+/*!
+The file functions in tp_utils are set up by tp_utils_filesystem::init(), this must be called before
+anything in here is used, including runCommandLine().
+*/
 namespace general_configurator
 {
 
 //##################################################################################################
 std::string extractPrefix(const std::string& name);
 
+//##################################################################################################
+enum class ModuleType
+{
+  Unknown,
+  Lib,
+  Subdirs,
+  App
+};
+
+//##################################################################################################
+std::string moduleTypeToString(ModuleType type);
+
+//##################################################################################################
+ModuleType moduleTypeFromString(const std::string& type);
+
+//##################################################################################################
+enum class CloneMode
+{
+  Full,    //!< A normal clone with full history and working tree.
+  Metadata //!< A shallow, blob filtered clone with only the .pri files checked out.
+};
+
+//##################################################################################################
+std::string cloneModeToString(CloneMode mode);
+
+//##################################################################################################
+CloneMode cloneModeFromString(const std::string& mode);
+
 //##################################################################################################
 struct Module
 {
@@ -21,6 +55,8 @@ struct Module
   std::string type; //!< The TEMPLATE value either lib, app.
   std::string gitRepoURL;
   std::string gitRepoPrefix;
+  std::string gitHead; //!< The commit that the dependencies were read from.
+  CloneMode cloneMode{CloneMode::Full}; //!< How the repo was cloned into the cache.
   std::unordered_set<tp_utils::StringID> dependencies;
 
 
@@ -30,6 +66,9 @@ struct Module
   //################################################################################################
   std::string suffix() const;
 
+  //################################################################################################
+  ModuleType moduleType() const;
+
   //################################################################################################
   nlohmann::json saveState() const;
 
@@ -37,9 +76,6 @@ struct Module
   void loadState(const nlohmann::json& j);
 };
 
-//##################################################################################################
-int runCommand(const std::string& workingDirectory, const std::string& command);
-
 //##################################################################################################
 std::string generateModuleName(const std::string& modulePrefix,
                                const std::string& moduleSuffix);
@@ -0,0 +1,95 @@
+#ifndef general_configurator_core_LibrarySelection_h
+#define general_configurator_core_LibrarySelection_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <unordered_map>
+
+namespace general_configurator
+{
+class Cache;
+
+//##################################################################################################
+//! The libraries picked for a new app and everything they depend on.
+/*!
+The dependencies of the template and the libraries that the user picks are the roots of the
+selection. Each module keeps a count of the roots whose dependency closure contains it, so picking
+or unpicking a library only touches the modules in its closure.
+
+Module ids are the ids of Cache::graph(), the selection must be reset when the cache changes.
+*/
+class LibrarySelection
+{
+public:
+  //################################################################################################
+  enum class State
+  {
+    Unchecked, //!< Not needed by anything that is selected.
+    Partial,   //!< Not picked but a dependency of something that is.
+    Checked    //!< Picked by the user or a direct dependency of the template.
+  };
+
+  //################################################################################################
+  //! Start a new selection that contains the dependencies of the template.
+  void reset(const Cache& cache, const tp_utils::StringID& templateName);
+
+  //################################################################################################
+  //! Pick a library, its dependencies become partially checked.
+  /*!
+  \param changed Optional output for the modules whose state changed.
+  */
+  void check(uint32_t id, std::vector<uint32_t>* changed=nullptr);
+
+  //################################################################################################
+  //! Unpick a library and every picked library that depends on it.
+  /*!
+  Required modules can't be unchecked, this does nothing for them.
+
+  \param changed Optional output for the modules whose state changed.
+  */
+  void uncheck(uint32_t id, std::vector<uint32_t>* changed=nullptr);
+
+  //################################################################################################
+  State state(uint32_t id) const;
+
+  //################################################################################################
+  //! Returns true if the module is needed by the template.
+  bool required(uint32_t id) const;
+
+  //################################################################################################
+  //! The checked modules, these are the direct dependencies of the new app.
+  const std::unordered_set<tp_utils::StringID>& selectedLibraries() const;
+
+  //################################################################################################
+  //! The checked modules and all of their dependencies, including ones that are not in the cache.
+  const std::unordered_set<tp_utils::StringID>& allDependencies() const;
+
+private:
+  //################################################################################################
+  void addRoot(uint32_t id, std::vector<uint32_t>* changed);
+
+  //################################################################################################
+  void removeRoot(uint32_t id, std::vector<uint32_t>* changed);
+
+  //################################################################################################
+  void addDependency(const tp_utils::StringID& name);
+
+  //################################################################################################
+  void removeDependency(const tp_utils::StringID& name);
+
+  const Cache* m_cache{nullptr};
+
+  std::vector<bool> m_roots;
+  std::vector<bool> m_required;
+  std::vector<uint32_t> m_counts;   //!< The number of roots that each module is in the closure of.
+
+  //! Counts for dependencies that are not in the cache, by name.
+  std::unordered_map<tp_utils::StringID, uint32_t> m_missingCounts;
+
+  std::unordered_set<tp_utils::StringID> m_selectedLibraries;
+  std::unordered_set<tp_utils::StringID> m_allDependencies;
+};
+
+}
+
+#endif
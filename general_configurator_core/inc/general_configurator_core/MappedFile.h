@@ -0,0 +1,52 @@
+#ifndef general_configurator_core_MappedFile_h
+#define general_configurator_core_MappedFile_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <string_view>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! A read only memory mapping of a whole file, the file is read into memory where mmap is missing.
+class MappedFile
+{
+  TP_NONCOPYABLE(MappedFile);
+public:
+  //################################################################################################
+  //! Map path, size() is 0 if the file could not be opened or is empty.
+  MappedFile(const std::string& path);
+
+  //################################################################################################
+  ~MappedFile();
+
+  //################################################################################################
+  const char* data() const
+  {
+    return m_data;
+  }
+
+  //################################################################################################
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  //################################################################################################
+  std::string_view view() const
+  {
+    return std::string_view(m_data, m_size);
+  }
+
+private:
+#ifdef _WIN32
+  std::string m_buffer;
+#endif
+  const char* m_data{nullptr};
+  size_t m_size{0};
+};
+
+}
+
+#endif
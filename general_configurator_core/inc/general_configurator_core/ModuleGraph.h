@@ -0,0 +1,120 @@
+#ifndef general_configurator_core_ModuleGraph_h
+#define general_configurator_core_ModuleGraph_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <unordered_map>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! A compact, immutable dependency graph built from a list of modules.
+/*!
+Modules are identified by dense ids that match their index in the list the graph was built from.
+Dependencies and reverse dependencies are stored as CSR arrays and only include modules that are in
+the list, self dependencies and duplicate names are ignored. The transitive closure is precomputed
+as one bitset row per module.
+*/
+class ModuleGraph
+{
+public:
+  //################################################################################################
+  //! A range of module ids.
+  struct IDs
+  {
+    const uint32_t* b{nullptr};
+    const uint32_t* e{nullptr};
+
+    const uint32_t* begin() const {return b;}
+    const uint32_t* end() const {return e;}
+    size_t size() const {return size_t(e-b);}
+    bool empty() const {return b==e;}
+  };
+
+  //################################################################################################
+  static constexpr uint32_t invalidID = ~uint32_t(0);
+
+  //################################################################################################
+  ModuleGraph() = default;
+
+  //################################################################################################
+  explicit ModuleGraph(const std::vector<Module>& modules);
+
+  //################################################################################################
+  size_t size() const;
+
+  //################################################################################################
+  //! Returns the id of the module or invalidID if it is not in the graph.
+  uint32_t id(const tp_utils::StringID& name) const;
+
+  //################################################################################################
+  const tp_utils::StringID& name(uint32_t id) const;
+
+  //################################################################################################
+  ModuleType type(uint32_t id) const;
+
+  //################################################################################################
+  //! Returns an id that is shared by all modules with the same prefix.
+  uint32_t prefixID(uint32_t id) const;
+
+  //################################################################################################
+  //! Direct dependencies of a module.
+  IDs dependencies(uint32_t id) const;
+
+  //################################################################################################
+  //! Modules that directly depend on a module.
+  IDs dependents(uint32_t id) const;
+
+  //################################################################################################
+  //! Returns true if dependency is of or one of its direct or indirect dependencies.
+  bool isDependency(uint32_t dependency, uint32_t of) const;
+
+  //################################################################################################
+  //! Returns the modules and all their dependencies in ascending id order.
+  std::vector<uint32_t> closure(const std::vector<uint32_t>& ids) const;
+
+  //################################################################################################
+  //! Returns the modules that directly or indirectly depend on any of ids, in ascending id order.
+  /*!
+  The ids themselves are only included if they depend on one of the other ids.
+  */
+  std::vector<uint32_t> dependentClosure(const std::vector<uint32_t>& ids) const;
+
+  //################################################################################################
+  //! Order modules so that dependencies come first and modules are grouped by prefix.
+  /*!
+  Ties are broken by id, so the order is deterministic. Modules that are in or depend on a cycle
+  can't be placed, they are appended to the order in id order and cycle is set to the modules that
+  are actually on a cycle.
+
+  \return true if all modules were sorted, false if there was a dependency cycle.
+  */
+  bool sortOrder(std::vector<uint32_t>& order, std::vector<uint32_t>* cycle=nullptr) const;
+
+private:
+  //################################################################################################
+  void buildClosure();
+
+  //################################################################################################
+  std::vector<uint32_t> kahnOrder(const std::vector<size_t>& keys) const;
+
+  std::unordered_map<tp_utils::StringID, uint32_t> m_ids;
+  std::vector<tp_utils::StringID> m_names;
+  std::vector<ModuleType> m_types;
+  std::vector<uint32_t> m_prefixIDs;
+
+  std::vector<uint32_t> m_dependencyOffsets{0};
+  std::vector<uint32_t> m_dependencies;
+
+  std::vector<uint32_t> m_dependentOffsets{0};
+  std::vector<uint32_t> m_dependents;
+
+  //! Row i has bit j set if module j is module i or one of its direct or indirect dependencies.
+  std::vector<uint64_t> m_closure;
+  size_t m_closureWords{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef general_configurator_core_ModuleSearchIndex_h
+#define general_configurator_core_ModuleSearchIndex_h
+
+#include "general_configurator_core/Globals.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct ModuleQuery
+{
+  std::string text;               //!< Whitespace separated terms that must all be in the name, case insensitive.
+  std::string prefix;             //!< Only return modules with this prefix, empty for any.
+  std::vector<ModuleType> types;  //!< Only return modules of these types, empty for any.
+
+  //################################################################################################
+  //! Returns true if the query does not filter anything.
+  bool empty() const;
+};
+
+//##################################################################################################
+//! A trigram index over module names for search as you type.
+/*!
+Module ids match the index of the module in the list the index was built from, like ModuleGraph.
+Each distinct three character sequence in the lower case names has a sorted list of the modules
+that contain it, stored as CSR arrays. Terms of three or more characters intersect the lists of
+their trigrams, starting with the shortest, and only the candidates that survive are compared
+against the names.
+*/
+class ModuleSearchIndex
+{
+public:
+  //################################################################################################
+  ModuleSearchIndex() = default;
+
+  //################################################################################################
+  explicit ModuleSearchIndex(const std::vector<Module>& modules);
+
+  //################################################################################################
+  //! Returns the ids of the modules that match the query in ascending order.
+  std::vector<uint32_t> search(const ModuleQuery& query) const;
+
+  //################################################################################################
+  //! The distinct module prefixes in alphabetical order, for a prefix facet.
+  const std::vector<std::string>& prefixes() const;
+
+  //################################################################################################
+  //! The distinct module types in the index, for a type facet.
+  const std::vector<ModuleType>& types() const;
+
+private:
+  //################################################################################################
+  //! Returns the modules that contain the trigram, an empty range if there are none.
+  std::pair<const uint32_t*, const uint32_t*> postings(uint32_t trigram) const;
+
+  std::vector<std::string> m_lowerNames;
+  std::vector<uint32_t> m_prefixIndexes; //!< The index in m_prefixes of each module's prefix.
+  std::vector<ModuleType> m_moduleTypes;
+
+  std::vector<std::string> m_prefixes;
+  std::vector<ModuleType> m_types;
+
+  std::vector<uint32_t> m_trigrams;           //!< Sorted distinct trigrams.
+  std::vector<uint32_t> m_postingOffsets{0};  //!< Offsets into m_postings for each trigram.
+  std::vector<uint32_t> m_postings;
+};
+
+}
+
+#endif
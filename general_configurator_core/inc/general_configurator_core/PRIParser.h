@@ -0,0 +1,64 @@
+#ifndef general_configurator_core_PRIParser_h
+#define general_configurator_core_PRIParser_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+enum class PRIOperator
+{
+  Assign,       //!< VAR = values
+  Append,       //!< VAR += values
+  AppendUnique, //!< VAR *= values
+  Remove,       //!< VAR -= values
+  Replace       //!< VAR ~= s/regex/replacement/
+};
+
+//##################################################################################################
+//! A single variable assignment from a qmake project file.
+/*!
+The views point into the data passed to parsePRI and are only valid for the duration of the callback.
+*/
+struct PRIStatement
+{
+  std::string_view variable;
+  PRIOperator op{PRIOperator::Assign};
+  std::vector<std::string_view> values; //!< Quotes are removed, $$ references are not expanded.
+  std::string_view scope;               //!< Enclosing scopes joined with ':', e.g. "linux:!android", empty if global.
+};
+
+//##################################################################################################
+//! Tokenize the contents of a qmake .pro or .pri file and call closure for each assignment.
+/*!
+This handles comments, backslash line continuations, multiple values per line, quoted values,
+single line scopes "linux: VAR += x" and block scopes "linux { VAR += x } else { ... }". Function
+calls and other statements that are not assignments are skipped.
+
+The tokenizer does not allocate per line, the values vector in the statement is reused.
+*/
+void parsePRI(std::string_view data, const std::function<void(const PRIStatement&)>& closure);
+
+//##################################################################################################
+using PRIVariables = std::unordered_map<std::string, std::vector<std::string>>;
+
+//##################################################################################################
+//! Expand $$VAR, $${VAR} and $$(ENV) references in a value.
+std::string expandPRIValue(std::string_view value, const PRIVariables& variables);
+
+//##################################################################################################
+//! Read a .pri file and evaluate its assignments.
+/*!
+Assignments outside of any scope are applied with normal qmake semantics. Scoped assignments can't
+be evaluated without knowing the target platform so they only ever add values, this gives the union
+of the values for all platforms which is what the configurator needs when collecting dependencies.
+*/
+PRIVariables evaluatePRIFile(const std::string& path);
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef general_configurator_core_ParallelTasks_h
+#define general_configurator_core_ParallelTasks_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <mutex>
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! Queue progress messages from worker threads to be forwarded on the thread that owns the progress.
+class ProgressMessages
+{
+public:
+  //################################################################################################
+  void addMessage(const std::string& message);
+
+  //################################################################################################
+  void addError(const std::string& error);
+
+  //################################################################################################
+  //! Forward and clear the queued messages, call this from the thread that owns progress.
+  void forward(tp_utils::Progress* progress);
+
+private:
+  std::mutex m_mutex;
+  std::vector<std::pair<bool, std::string>> m_messages;
+};
+
+//##################################################################################################
+//! Run a task for each index in [0, count) on a pool of worker threads.
+/*!
+While the tasks run the calling thread calls idle roughly every 50ms, this is where progress should
+be reported from. Once a task fails, or idle returns false, no new tasks are started but the ones
+that are already running are allowed to finish.
+
+\param count The number of tasks to run.
+\param maxThreads The maximum number of concurrent tasks, 0 uses the number of hardware threads.
+\param stopOnFailure If true no new tasks are started once a task has failed.
+\param task Called from a worker thread with the index of the task, returns false on failure.
+\param idle Called on the calling thread while waiting, return false to cancel the remaining tasks.
+\return true if all of the tasks ran and returned true.
+*/
+bool runParallel(size_t count,
+                 size_t maxThreads,
+                 bool stopOnFailure,
+                 const std::function<bool(size_t)>& task,
+                 const std::function<bool()>& idle);
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef general_configurator_core_Process_h
+#define general_configurator_core_Process_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <functional>
+#include <vector>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct ProcessParams
+{
+  std::vector<std::string> arguments; //!< The program followed by its arguments, the program is found using PATH.
+  std::string workingDirectory;       //!< Empty to use the current directory.
+  int64_t timeoutMS{0};               //!< Kill the process if it runs for longer than this, 0 for no limit.
+};
+
+//##################################################################################################
+struct ProcessResult
+{
+  int exitCode{-1};       //!< The exit code, 128 + the signal number if the process was killed.
+  bool timedOut{false};
+  bool cancelled{false};
+  std::string error;      //!< Set if the process could not be started.
+  std::string output;     //!< Everything the process wrote to stdout and stderr, one line at a time.
+
+  //################################################################################################
+  bool success() const;
+
+  //################################################################################################
+  //! A description of why the process failed, for error messages.
+  std::string errorMessage() const;
+};
+
+//##################################################################################################
+//! Receives the output and decides when to stop, the callbacks are called on the waiting thread.
+struct ProcessObserver
+{
+  std::function<void(const std::string& line)> output; //!< Each line written to stdout or stderr.
+  std::function<bool()> shouldStop;                     //!< Polled while waiting, return true to kill the process.
+};
+
+//##################################################################################################
+//! Run a process and wait for it to finish, no shell is involved so arguments are never split or expanded.
+/*!
+Everything happens on the calling thread, the output pipes are serviced with poll and shouldStop is
+polled roughly every 50ms. Several processes can be run at the same time from different threads.
+
+On Windows the process is run through the shell and its output goes to stderr instead of being captured.
+*/
+ProcessResult runProcess(const ProcessParams& params, const ProcessObserver& observer=ProcessObserver());
+
+//##################################################################################################
+//! Run several tasks, each a sequence of processes, with at most maxConcurrent processes at a time.
+/*!
+Everything happens on the calling thread, one poll loop services the output pipes of all of the
+running processes. When a task is ready for its next process nextProcess is called with the result
+of the previous one, or nullptr to start the task, and returns false once the task is complete.
+
+If shouldStop returns true the running processes are killed, nextProcess is given their cancelled
+results but nothing else is started. Tasks that were never started are not passed to nextProcess.
+
+On Windows the processes are run one at a time through the shell and their output goes to stderr.
+
+\param maxConcurrent The maximum number of running processes, 0 for one per hardware thread.
+\param nextProcess Called with the index of the task, the previous result and the params to fill in.
+\param output Called with the index of the task, each line written and true if it was on stderr.
+\param shouldStop Polled roughly every 50ms.
+*/
+void runProcesses(size_t taskCount,
+                  size_t maxConcurrent,
+                  const std::function<bool(size_t, const ProcessResult*, ProcessParams&)>& nextProcess,
+                  const std::function<void(size_t, const std::string&, bool)>& output,
+                  const std::function<bool()>& shouldStop);
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef general_configurator_core_ReplaceNames_h
+#define general_configurator_core_ReplaceNames_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <array>
+#include <functional>
+#include <string_view>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+//! Finds several literal patterns in one pass over a text using an Aho-Corasick automaton.
+class MultiPatternMatcher
+{
+public:
+  //################################################################################################
+  //! Empty patterns are ignored, if a pattern is repeated the first one is used.
+  MultiPatternMatcher(const std::vector<std::string>& patterns);
+
+  //################################################################################################
+  //! Calls found(position, pattern) for each leftmost longest non-overlapping match, in order.
+  void findAll(std::string_view text, const std::function<void(size_t, size_t)>& found) const;
+
+  //################################################################################################
+  //! Returns the index of the longest pattern that text starts with or npos if there is none.
+  size_t longestPrefix(std::string_view text) const;
+
+  //################################################################################################
+  size_t patternLength(size_t pattern) const;
+
+  //################################################################################################
+  static constexpr size_t npos = ~size_t(0);
+
+private:
+  std::vector<std::array<uint32_t, 256>> m_next; //!< Complete transition table, goto and fail merged.
+  std::vector<uint32_t> m_depth;
+  std::vector<size_t> m_terminal;      //!< The pattern that ends at each node or npos.
+  std::vector<size_t> m_longestMatch;  //!< The longest pattern that is a suffix of each node or npos.
+  std::vector<size_t> m_patternLengths;
+};
+
+//##################################################################################################
+struct ReplaceRule
+{
+  std::string from;
+  std::string to;
+};
+
+//##################################################################################################
+struct ReplaceStats
+{
+  size_t filesScanned{0};
+  size_t bytesScanned{0};
+  size_t binaryFiles{0};  //!< Files that were not scanned because they contain nul bytes.
+  size_t filesChanged{0};
+  size_t pathsRenamed{0};
+
+  int64_t listMS{0};    //!< Time spent listing the tree.
+  int64_t replaceMS{0}; //!< Time spent scanning and rewriting file contents.
+  int64_t renameMS{0};  //!< Time spent renaming files and directories.
+};
+
+//##################################################################################################
+//! Rename files and replace text in a directory tree, for example to rename a module.
+/*!
+Every occurrence of a rule's from in the text files is replaced with its to, the rules are matched
+together so text produced by one rule is never replaced again by another, where matches overlap the
+leftmost longest one wins. Only files with matches are rewritten, through a temporary file that is
+renamed over the original. Files that look binary are left alone. The files are processed on a pool
+of threads, the result is the same whatever the number of threads.
+
+Once all of the contents have been replaced, files and directories whose names start with a rule's
+from have that prefix replaced, the tree is renamed bottom up.
+
+\param directory The directory to process, its own name is not changed.
+\param rules The patterns are literal strings, no characters have a special meaning.
+\param error Set to a description of the first failure.
+\param stats Optional output for what was done.
+\param maxThreads The number of files to process at the same time, 0 for one per hardware thread.
+\return true on success.
+*/
+bool replaceNames(const std::string& directory,
+                  const std::vector<ReplaceRule>& rules,
+                  std::string& error,
+                  ReplaceStats* stats=nullptr,
+                  size_t maxThreads=0);
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef general_configurator_core_UpdateCache_h
+#define general_configurator_core_UpdateCache_h
+
+#include "general_configurator_core/Globals.h"
+
+#include <atomic>
+
+namespace tp_utils
+{
+class Progress;
+}
+
+namespace general_configurator
+{
+class Cache;
+
+//##################################################################################################
+struct UpdateCacheParams
+{
+  size_t maxParallelClones{4};  //!< The number of repos to clone at the same time, 0 for one per hardware thread.
+  size_t maxParallelReads{0};   //!< The number of modules to read at the same time, 0 for one per hardware thread.
+  bool continueOnError{false};  //!< Keep cloning the other repos if one fails, the update still fails.
+  bool incremental{false};      //!< Fetch existing repos and only re-read the ones that moved.
+  CloneMode cloneMode{CloneMode::Full}; //!< Metadata clones only fetch what is needed to read the .pri files.
+  bool useTpUpdate{false};      //!< Fetch submodules with the external "tpUpdate noupdate" instead of fetchSubmodules.
+
+  //! Optional, checked while tpUpdate runs so that a cancel does not wait for the progress to poll.
+  const std::atomic<bool>* cancel{nullptr};
+};
+
+//##################################################################################################
+bool updateCache(Cache& cache, tp_utils::Progress* progress, const UpdateCacheParams& params=UpdateCacheParams());
+
+//##################################################################################################
+//! Does the work of updateCache but returns the modules instead of setting them on the cache.
+/*!
+The cache is only read so this can run on a worker thread, as long as the cache is not changed
+until it returns. Pass the modules to Cache::setModules on the thread that owns the cache.
+
+\return true if the update succeeded and modules is valid.
+*/
+bool updateCacheModules(const Cache& cache,
+                        tp_utils::Progress* progress,
+                        std::vector<Module>& modules,
+                        const UpdateCacheParams& params=UpdateCacheParams());
+
+//##################################################################################################
+//! Read the modules back from the repos that an earlier update checked out, nothing is fetched.
+/*!
+This is used to rebuild the index when it can't be read. The source repos are not stored in the
+repos so they are taken to be the repos that no other repo lists in its submodules.pri.
+
+\param reposDirectory The directory that updateCache checked the repos out into.
+\param sourceRepos Set to the URLs of the repos that no other repo references.
+\param modules Set to the modules in path order, sort them with Cache::sortModules.
+*/
+void readCacheRepos(const std::string& reposDirectory,
+                    std::vector<std::string>& sourceRepos,
+                    std::vector<Module>& modules);
+
+//##################################################################################################
+std::unordered_set<tp_utils::StringID> parseSubmodules(const std::string& path);
+
+//##################################################################################################
+//! Returns the repo that a SUBDIRS entry lives in.
+/*!
+Modules that live inside another repo are listed as repo/module, only the repo can be cloned.
+*/
+std::string submoduleRepoName(const std::string& subdir);
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "general_configurator_core/BackgroundTask.h"
+
+#include "tp_utils/Progress.h"
+
+#include <mutex>
+#include <thread>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct BackgroundTask::Private
+{
+  TP_NONCOPYABLE(Private);
+  Private() = default;
+
+  mutable std::mutex mutex;
+  BackgroundTaskState state;
+  std::atomic<bool> cancel{false};
+  std::thread thread;
+
+  //################################################################################################
+  //! Called on the worker thread each time the progress polls.
+  void publish(tp_utils::Progress* progress)
+  {
+    if(cancel && !progress->shouldStop())
+      progress->stop(true);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    state.progress = progress->progress();
+    state.description = progress->description();
+  }
+};
+
+//##################################################################################################
+BackgroundTask::BackgroundTask(const std::string& message,
+                               const std::function<bool(tp_utils::Progress*, const std::atomic<bool>& cancel)>& closure):
+  d(new Private())
+{
+  d->state.description = message;
+  d->thread = std::thread([this, message, closure]
+  {
+    tp_utils::Progress* progressPtr=nullptr;
+    tp_utils::Progress progress([&]
+    {
+      if(progressPtr)
+        d->publish(progressPtr);
+      return true;
+    }, message);
+    progressPtr = &progress;
+
+    bool success = closure(&progress, d->cancel);
+
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->state.progress = 1.0f;
+    d->state.finished = true;
+    d->state.success = success;
+    d->state.error = progress.errorMessage();
+  });
+}
+
+//##################################################################################################
+BackgroundTask::~BackgroundTask()
+{
+  cancel();
+  wait();
+  delete d;
+}
+
+//##################################################################################################
+void BackgroundTask::cancel()
+{
+  d->cancel = true;
+  std::lock_guard<std::mutex> lock(d->mutex);
+  d->state.cancelled = true;
+}
+
+//##################################################################################################
+BackgroundTaskState BackgroundTask::state() const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  return d->state;
+}
+
+//##################################################################################################
+void BackgroundTask::wait()
+{
+  if(d->thread.joinable())
+    d->thread.join();
+}
+
+}
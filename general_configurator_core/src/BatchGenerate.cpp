@@ -0,0 +1,387 @@
+#include "general_configurator_core/BatchGenerate.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/ModuleGraph.h"
+#include "general_configurator_core/ParallelTasks.h"
+#include "general_configurator_core/Process.h"
+
+#include "tp_utils/Progress.h"
+#include "tp_utils/FileUtils.h"
+#include "tp_utils/JSONUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+nlohmann::json BatchJob::saveState() const
+{
+  nlohmann::json j;
+
+  j["template"] = templateModule.toString();
+  j["rootPath"] = rootPath;
+  j["prefix"] = prefix;
+  j["suffix"] = suffix;
+
+  // Sorted so that reports don't depend on hash order.
+  std::vector<std::string> sortedLibraries;
+  sortedLibraries.reserve(libraries.size());
+  for(const auto& library : libraries)
+    sortedLibraries.push_back(library.toString());
+  std::sort(sortedLibraries.begin(), sortedLibraries.end());
+
+  j["libraries"] = nlohmann::json::array();
+  for(const auto& library : sortedLibraries)
+    j["libraries"].push_back(library);
+
+  return j;
+}
+
+//##################################################################################################
+void BatchJob::loadState(const nlohmann::json& j)
+{
+  templateModule = TPJSONString(j, "template");
+  rootPath = TPJSONString(j, "rootPath");
+  prefix = TPJSONString(j, "prefix");
+  suffix = TPJSONString(j, "suffix");
+
+  libraries.clear();
+  if(auto i=j.find("libraries"); i!=j.end() && i->is_array())
+    for(const auto& jj : *i)
+      if(jj.is_string())
+        libraries.insert(jj.get<std::string>());
+}
+
+//##################################################################################################
+nlohmann::json BatchJobResult::saveState() const
+{
+  nlohmann::json j;
+  j["success"] = success;
+  j["appPath"] = appPath;
+  j["dependencyCount"] = dependencyCount;
+  j["elapsedMS"] = elapsedMS;
+  j["error"] = error;
+  return j;
+}
+
+//##################################################################################################
+bool loadBatchManifest(const std::string& path, std::vector<BatchJob>& jobs, std::string& error)
+{
+  nlohmann::json j = nlohmann::json::parse(tp_utils::readTextFile(path), nullptr, false);
+  if(j.is_discarded())
+  {
+    error = "Failed to parse manifest: " + path;
+    return false;
+  }
+
+  const nlohmann::json* jobsArray = &j;
+  if(j.is_object())
+    if(auto i=j.find("jobs"); i!=j.end())
+      jobsArray = &(*i);
+
+  if(!jobsArray->is_array())
+  {
+    error = "Expected an array of jobs in: " + path;
+    return false;
+  }
+
+  jobs.clear();
+  for(const auto& jj : *jobsArray)
+  {
+    if(!jj.is_object())
+    {
+      error = "Expected each job to be an object in: " + path;
+      return false;
+    }
+
+    jobs.emplace_back().loadState(jj);
+  }
+
+  return true;
+}
+
+//##################################################################################################
+bool generateBatch(const Cache& cache,
+                   const std::vector<BatchJob>& jobs,
+                   const BatchParams& params,
+                   tp_utils::Progress* progress,
+                   std::vector<BatchJobResult>& results)
+{
+  results.clear();
+  results.resize(jobs.size());
+
+  // The libraries of each job including the template dependencies, like LibrarySelection::reset.
+  std::vector<std::unordered_set<tp_utils::StringID>> allSelectedLibraries(jobs.size());
+
+  // The dependencies of each job resolved against the cache.
+  std::vector<std::unordered_set<tp_utils::StringID>> allDependencies(jobs.size());
+  std::vector<size_t> runnable;
+
+  //-- Resolve the dependencies of each job --------------------------------------------------------
+  {
+    auto p = progress->addChildStep("Resolving dependencies", 0.05f);
+
+    // Two jobs writing to the same directory would clobber each other.
+    std::unordered_set<std::string> appPaths;
+
+    for(size_t i=0; i<jobs.size(); i++)
+    {
+      const auto& job = jobs.at(i);
+      auto& result = results.at(i);
+      result.appPath = generateAppPathString(job.rootPath, job.prefix, job.suffix);
+
+      const Module* templateModule = cache.findModule(job.templateModule);
+      if(!templateModule)
+      {
+        result.error = "Failed to find template module: " + job.templateModule.toString();
+        continue;
+      }
+
+      if(job.rootPath.empty() || job.prefix.empty() || job.suffix.empty())
+      {
+        result.error = "The rootPath, prefix and suffix must all be set.";
+        continue;
+      }
+
+      // Only the libraries that were asked for must be in the cache, like the GUI the dependencies
+      // that are not in the cache are passed through to the generated app.
+      for(const auto& name : job.libraries)
+      {
+        if(!cache.findModule(name))
+        {
+          result.error = "Failed to find library: " + name.toString();
+          break;
+        }
+      }
+
+      if(!result.error.empty())
+        continue;
+
+      // Reserve the directory last so a job that fails validation does not block a later one.
+      if(auto topLevelPath = generateTopLevelPathString(job.rootPath, job.prefix, job.suffix);
+         !appPaths.insert(topLevelPath).second)
+      {
+        result.error = "Another job already generates into: " + topLevelPath;
+        continue;
+      }
+
+      auto& selectedLibraries = allSelectedLibraries.at(i);
+      selectedLibraries = job.libraries;
+      for(const auto& dependency : templateModule->dependencies)
+        if(cache.graph().id(dependency) != ModuleGraph::invalidID)
+          selectedLibraries.insert(dependency);
+
+      std::unordered_set<tp_utils::StringID> names = selectedLibraries;
+      for(const auto& dependency : templateModule->dependencies)
+        names.insert(dependency);
+
+      allDependencies.at(i) = cache.dependencyClosure(names);
+      result.dependencyCount = allDependencies.at(i).size();
+      runnable.push_back(i);
+    }
+
+    for(const auto& result : results)
+      if(!result.error.empty())
+        p->addError("Skipping: " + result.appPath + " " + result.error);
+
+    p->setProgress(1.0f, "Done.");
+  }
+
+  //-- Prepare a snapshot of each template ---------------------------------------------------------
+  // Every job copies its template from one checkout, either the one in the cache or a single clone
+  // shared by all of the jobs that use the template, rather than each job cloning it.
+  std::unordered_map<tp_utils::StringID, std::string> snapshots;
+  std::string snapshotsDirectory = tp_utils::pathAppend(cache.cacheDirectory(), "batch_templates");
+  {
+    auto p = progress->addChildStep("Preparing templates", 0.1f);
+
+    std::vector<const Module*> toClone;
+    for(auto i : runnable)
+    {
+      const auto& templateName = jobs.at(i).templateModule;
+      if(snapshots.find(templateName) != snapshots.end())
+        continue;
+
+      const Module* templateModule = cache.findModule(templateName);
+      std::string reason;
+      snapshots[templateName] = usableCacheCheckout(cache, *templateModule, reason);
+      if(!reason.empty())
+      {
+        p->addMessage("Cloning " + templateName.toString() + " once because " + reason + ".");
+        toClone.push_back(templateModule);
+      }
+    }
+
+    if(!toClone.empty())
+    {
+      tp_utils::rm(snapshotsDirectory, TPRecursive::Yes);
+      tp_utils::mkdir(snapshotsDirectory, TPCreateFullPath::Yes);
+    }
+
+    ProgressMessages messages;
+    std::atomic<size_t> done{0};
+    std::atomic<bool> stop{false};
+    std::vector<std::string> clonedPaths(toClone.size());
+    runParallel(toClone.size(), params.generateParams.maxParallelFetches, false, [&](size_t t)
+    {
+      const Module* templateModule = toClone.at(t);
+      std::string path = tp_utils::pathAppend(snapshotsDirectory, templateModule->name.toString());
+
+      ProcessObserver observer;
+      observer.shouldStop = [&]{return stop || (params.generateParams.cancel && *params.generateParams.cancel);};
+      auto result = runProcess({{"git", "clone", templateModule->gitRepoURL, path}, snapshotsDirectory}, observer);
+      if(result.success())
+        clonedPaths[t] = path;
+      else
+        messages.addError("Failed to clone: " + templateModule->gitRepoURL + " " + result.errorMessage());
+
+      done++;
+      return result.success();
+    }, [&]
+    {
+      messages.forward(p);
+      p->setProgress(float(done)/float(std::max(size_t(1), toClone.size())));
+      if(p->shouldStop())
+        stop = true;
+      return !stop;
+    });
+    messages.forward(p);
+
+    for(size_t t=0; t<toClone.size(); t++)
+      snapshots[toClone.at(t)->name] = clonedPaths.at(t);
+
+    // Jobs whose template could not be cloned are not started.
+    runnable.erase(std::remove_if(runnable.begin(), runnable.end(), [&](size_t i)
+    {
+      if(!snapshots[jobs.at(i).templateModule].empty())
+        return false;
+
+      results.at(i).error = "Failed to clone template: " + jobs.at(i).templateModule.toString();
+      return true;
+    }), runnable.end());
+
+    p->setProgress(1.0f, "Done.");
+  }
+
+  //-- Generate the apps ---------------------------------------------------------------------------
+  {
+    auto p = progress->addChildStep("Generating " + std::to_string(runnable.size()) + " apps", 1.0f);
+
+    ProgressMessages messages;
+    std::atomic<size_t> done{0};
+
+    // Set from the idle callback so a stop also reaches the jobs that are running and their processes.
+    std::atomic<bool> cancel{false};
+    auto updateCancel = [&]
+    {
+      if(p->shouldStop() || (params.generateParams.cancel && *params.generateParams.cancel))
+        cancel = true;
+      return !cancel;
+    };
+
+    // Cleared when a job starts, so jobs that were never started because of a cancel say so.
+    for(auto i : runnable)
+      results.at(i).error = "Cancelled.";
+
+    // Split the hardware threads between the jobs rather than giving each job a thread per core.
+    GenerateParams generateParams = params.generateParams;
+    if(generateParams.maxRewriteThreads == 0)
+    {
+      size_t hardwareThreads = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+      size_t parallelJobs = params.maxParallelJobs==0?hardwareThreads:params.maxParallelJobs;
+      parallelJobs = std::max(size_t(1), std::min(parallelJobs, runnable.size()));
+      generateParams.maxRewriteThreads = std::max(size_t(1), hardwareThreads/parallelJobs);
+    }
+    generateParams.cancel = &cancel;
+
+    // Each job gets its own copy of the params so that it can point at the snapshot of its template.
+
+    runParallel(runnable.size(), params.maxParallelJobs, false, [&](size_t r)
+    {
+      size_t i = runnable.at(r);
+      const auto& job = jobs.at(i);
+      auto& result = results.at(i);
+
+      result.error.clear();
+      auto start = std::chrono::steady_clock::now();
+
+      // Each job has its own progress because a progress can't be shared between threads.
+      tp_utils::Progress jobProgress([&]{return !cancel;});
+      GenerateParams jobParams = generateParams;
+      jobParams.templateSnapshot = snapshots.at(job.templateModule);
+      result.success = generateApp(cache,
+                                   job.templateModule,
+                                   job.rootPath,
+                                   job.prefix,
+                                   job.suffix,
+                                   allSelectedLibraries.at(i),
+                                   allDependencies.at(i),
+                                   &jobProgress,
+                                   jobParams);
+
+      result.elapsedMS = int64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+      if(result.success)
+        messages.addMessage("Generated: " + result.appPath + " in " + std::to_string(result.elapsedMS) + "ms");
+      else
+      {
+        result.error = jobProgress.errorMessage();
+        messages.addError("Failed to generate: " + result.appPath);
+      }
+
+      done++;
+      return result.success;
+    }, [&]
+    {
+      messages.forward(p);
+      p->setProgress(float(done)/float(std::max(size_t(1), runnable.size())));
+      return updateCancel();
+    });
+
+    messages.forward(p);
+  }
+
+  tp_utils::rm(snapshotsDirectory, TPRecursive::Yes);
+
+  size_t failed=0;
+  for(const auto& result : results)
+    if(!result.success)
+      failed++;
+
+  progress->addMessage("Generated " + std::to_string(jobs.size()-failed) + " of " + std::to_string(jobs.size()) + " apps.");
+  return failed==0;
+}
+
+//##################################################################################################
+nlohmann::json batchReport(const std::vector<BatchJob>& jobs, const std::vector<BatchJobResult>& results)
+{
+  nlohmann::json j;
+
+  size_t succeeded=0;
+  int64_t elapsedMS=0;
+
+  j["jobs"] = nlohmann::json::array();
+  for(size_t i=0; i<jobs.size() && i<results.size(); i++)
+  {
+    const auto& result = results.at(i);
+    nlohmann::json jj = jobs.at(i).saveState();
+    jj["result"] = result.saveState();
+    j["jobs"].push_back(jj);
+
+    if(result.success)
+      succeeded++;
+    elapsedMS += result.elapsedMS;
+  }
+
+  j["succeeded"] = succeeded;
+  j["failed"] = jobs.size()-succeeded;
+  j["totalJobMS"] = elapsedMS;
+
+  return j;
+}
+
+}
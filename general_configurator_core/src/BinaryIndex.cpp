@@ -0,0 +1,290 @@
+#include "general_configurator_core/BinaryIndex.h"
+#include "general_configurator_core/MappedFile.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+// File layout, all integers are little endian:
+//   Header
+//   uint32_t stringOffsets[stringCount+1]  Offsets of each string in the string data.
+//   char     stringData[stringBytes]
+//   uint32_t sourceRepos[sourceRepoCount]  String ids.
+//   Record   modules[moduleCount]
+//   uint32_t dependencies[edgeCount]       String ids, modules reference ranges of these.
+constexpr char magic[4] = {'G', 'C', 'B', 'I'};
+constexpr uint32_t version = 4;
+
+//##################################################################################################
+struct Header
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t checksum; //!< FNV-1a of everything after the header.
+  uint32_t stringCount;
+  uint32_t stringBytes;
+  uint32_t sourceRepoCount;
+  uint32_t moduleCount;
+  uint32_t edgeCount;
+};
+
+//##################################################################################################
+struct Record
+{
+  uint32_t name;
+  uint32_t path;
+  uint32_t type;
+  uint32_t gitRepoURL;
+  uint32_t gitRepoPrefix;
+  uint32_t gitHead;
+  uint32_t cloneMode;
+  uint32_t firstDependency;
+  uint32_t dependencyCount;
+};
+
+//##################################################################################################
+uint32_t checksum(const char* data, size_t size)
+{
+  uint32_t hash = 2166136261u;
+  for(size_t i=0; i<size; i++)
+  {
+    hash ^= uint8_t(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//##################################################################################################
+bool isLittleEndian()
+{
+  uint32_t v=1;
+  char c;
+  std::memcpy(&c, &v, 1);
+  return c==1;
+}
+
+//##################################################################################################
+template<typename T>
+void append(std::string& data, const T& value)
+{
+  data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}
+
+//##################################################################################################
+bool readBinaryIndex(const std::string& path,
+                     std::vector<std::string>& sourceRepos,
+                     std::vector<Module>& modules)
+{
+  if(!isLittleEndian())
+    return false;
+
+  MappedFile file(path);
+  if(file.size() < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, file.data(), sizeof(Header));
+
+  if(std::memcmp(header.magic, magic, 4)!=0 || header.version!=version)
+    return false;
+
+  const char* payload = file.data() + sizeof(Header);
+  size_t payloadSize = file.size() - sizeof(Header);
+
+  uint64_t expectedSize = (uint64_t(header.stringCount)+1) * sizeof(uint32_t) +
+      uint64_t(header.stringBytes) +
+      uint64_t(header.sourceRepoCount) * sizeof(uint32_t) +
+      uint64_t(header.moduleCount) * sizeof(Record) +
+      uint64_t(header.edgeCount) * sizeof(uint32_t);
+
+  if(expectedSize != payloadSize || checksum(payload, payloadSize) != header.checksum)
+    return false;
+
+  const char* offsets = payload;
+  const char* stringData = offsets + (size_t(header.stringCount)+1) * sizeof(uint32_t);
+  const char* sourceRepoIDs = stringData + header.stringBytes;
+  const char* records = sourceRepoIDs + size_t(header.sourceRepoCount) * sizeof(uint32_t);
+  const char* edges = records + size_t(header.moduleCount) * sizeof(Record);
+
+  auto readU32 = [](const char* base, size_t index)
+  {
+    uint32_t v;
+    std::memcpy(&v, base + index*sizeof(uint32_t), sizeof(uint32_t));
+    return v;
+  };
+
+  std::vector<std::string> strings;
+  strings.reserve(header.stringCount);
+  for(uint32_t i=0; i<header.stringCount; i++)
+  {
+    uint32_t begin = readU32(offsets, i);
+    uint32_t end = readU32(offsets, i+1);
+    if(begin>end || end>header.stringBytes)
+      return false;
+    strings.emplace_back(stringData+begin, end-begin);
+  }
+
+  bool ok=true;
+  auto string = [&](uint32_t id) -> const std::string&
+  {
+    static const std::string empty;
+    if(id<strings.size())
+      return strings[id];
+    ok = false;
+    return empty;
+  };
+
+  std::vector<std::string> newSourceRepos;
+  newSourceRepos.reserve(header.sourceRepoCount);
+  for(uint32_t i=0; i<header.sourceRepoCount; i++)
+    newSourceRepos.push_back(string(readU32(sourceRepoIDs, i)));
+
+  std::vector<Module> newModules;
+  newModules.reserve(header.moduleCount);
+  for(uint32_t i=0; i<header.moduleCount && ok; i++)
+  {
+    Record record;
+    std::memcpy(&record, records + size_t(i)*sizeof(Record), sizeof(Record));
+
+    if(uint64_t(record.firstDependency) + record.dependencyCount > header.edgeCount)
+      return false;
+
+    Module& module = newModules.emplace_back();
+    module.name = string(record.name);
+    module.path = string(record.path);
+    module.type = string(record.type);
+    module.gitRepoURL = string(record.gitRepoURL);
+    module.gitRepoPrefix = string(record.gitRepoPrefix);
+    module.gitHead = string(record.gitHead);
+    module.cloneMode = cloneModeFromString(string(record.cloneMode));
+
+    module.dependencies.reserve(record.dependencyCount);
+    for(uint32_t e=0; e<record.dependencyCount; e++)
+      module.dependencies.insert(string(readU32(edges, size_t(record.firstDependency)+e)));
+  }
+
+  if(!ok)
+    return false;
+
+  sourceRepos.swap(newSourceRepos);
+  modules.swap(newModules);
+  return true;
+}
+
+//##################################################################################################
+bool writeBinaryIndex(const std::string& path,
+                      const std::vector<std::string>& sourceRepos,
+                      const std::vector<Module>& modules)
+{
+  if(!isLittleEndian())
+    return false;
+
+  std::unordered_map<std::string, uint32_t> stringIDs;
+  std::vector<const std::string*> strings;
+  auto intern = [&](const std::string& s)
+  {
+    auto i = stringIDs.emplace(s, uint32_t(strings.size()));
+    if(i.second)
+      strings.push_back(&i.first->first);
+    return i.first->second;
+  };
+
+  std::vector<uint32_t> sourceRepoIDs;
+  sourceRepoIDs.reserve(sourceRepos.size());
+  for(const auto& sourceRepo : sourceRepos)
+    sourceRepoIDs.push_back(intern(sourceRepo));
+
+  std::vector<Record> records;
+  std::vector<uint32_t> edges;
+  std::vector<std::string> dependencies;
+  records.reserve(modules.size());
+  for(const auto& module : modules)
+  {
+    Record& record = records.emplace_back();
+    record.name = intern(module.name.toString());
+    record.path = intern(module.path);
+    record.type = intern(module.type);
+    record.gitRepoURL = intern(module.gitRepoURL);
+    record.gitRepoPrefix = intern(module.gitRepoPrefix);
+    record.gitHead = intern(module.gitHead);
+    record.cloneMode = intern(cloneModeToString(module.cloneMode));
+    record.firstDependency = uint32_t(edges.size());
+    record.dependencyCount = uint32_t(module.dependencies.size());
+
+    // Sorted so that the string ids and the file don't depend on hash order.
+    dependencies.clear();
+    for(const auto& dependency : module.dependencies)
+      dependencies.push_back(dependency.toString());
+    std::sort(dependencies.begin(), dependencies.end());
+    for(const auto& dependency : dependencies)
+      edges.push_back(intern(dependency));
+  }
+
+  std::string payload;
+  uint32_t stringBytes=0;
+  {
+    append(payload, stringBytes);
+    for(const auto& s : strings)
+    {
+      stringBytes += uint32_t(s->size());
+      append(payload, stringBytes);
+    }
+
+    for(const auto& s : strings)
+      payload += *s;
+
+    for(auto id : sourceRepoIDs)
+      append(payload, id);
+
+    for(const auto& record : records)
+      append(payload, record);
+
+    for(auto id : edges)
+      append(payload, id);
+  }
+
+  Header header{};
+  std::memcpy(header.magic, magic, 4);
+  header.version = version;
+  header.checksum = checksum(payload.data(), payload.size());
+  header.stringCount = uint32_t(strings.size());
+  header.stringBytes = stringBytes;
+  header.sourceRepoCount = uint32_t(sourceRepoIDs.size());
+  header.moduleCount = uint32_t(records.size());
+  header.edgeCount = uint32_t(edges.size());
+
+  std::string data;
+  data.reserve(sizeof(Header) + payload.size());
+  append(data, header);
+  data += payload;
+
+  // Write to a temporary file and rename so a reader never maps a half written index.
+  std::string tmpPath = path + ".tmp";
+  if(!tp_utils::writeBinaryFile(tmpPath, data))
+    return false;
+
+#ifdef _WIN32
+  // rename fails on Windows if the target exists.
+  return MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+}
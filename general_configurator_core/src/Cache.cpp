@@ -0,0 +1,348 @@
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/BinaryIndex.h"
+#include "general_configurator_core/ModuleGraph.h"
+#include "general_configurator_core/ModuleSearchIndex.h"
+#include "general_configurator_core/UpdateCache.h"
+
+#include "tp_utils/FileUtils.h"
+#include "tp_utils/DebugUtils.h"
+
+#include "json.hpp"
+
+#include <algorithm>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct Cache::Private
+{
+  Q* q;
+  const std::string cacheDirectory;
+  std::string loadError;
+
+  std::vector<std::string> sourceRepos;
+  std::vector<Module> modules;
+  ModuleGraph graph;
+  ModuleSearchIndex searchIndex;
+
+  //################################################################################################
+  Private(Q* q_, const std::string& cacheDirectory_):
+    q(q_),
+    cacheDirectory(cacheDirectory_)
+  {
+    tp_utils::mkdir(cacheDirectory, TPCreateFullPath::Yes);
+  }
+
+  //################################################################################################
+  void updateIndexes()
+  {
+    graph = ModuleGraph(modules);
+    searchIndex = ModuleSearchIndex(modules);
+  }
+
+  //################################################################################################
+  //! Only read when index.bin can't be, caches from before index.bin only have this. Never written.
+  std::string jsonIndexPath()
+  {
+    return tp_utils::pathAppend(cacheDirectory, "index.json");
+  }
+
+  //################################################################################################
+  //! Written by Cache::exportJSON, kept apart from index.json so an export is never loaded.
+  std::string exportPath()
+  {
+    return tp_utils::pathAppend(cacheDirectory, "index.export.json");
+  }
+
+  //################################################################################################
+  std::string binaryIndexPath()
+  {
+    return tp_utils::pathAppend(cacheDirectory, "index.bin");
+  }
+
+  //################################################################################################
+  bool save()
+  {
+    bool success = writeBinaryIndex(binaryIndexPath(), sourceRepos, modules);
+
+    q->changed();
+    return success;
+  }
+
+  //################################################################################################
+  //! Load the binary index, if that can't be read it is rebuilt from index.json or the repos.
+  void load()
+  {
+    if(readBinaryIndex(binaryIndexPath(), sourceRepos, modules))
+    {
+      updateIndexes();
+      return;
+    }
+
+    // Caches from older versions only have index.json, an index.bin from another version or that
+    // is corrupt is rebuilt from the repos that were checked out by the last update.
+    if(!tp_utils::exists(jsonIndexPath()) || !loadJSON(jsonIndexPath()))
+    {
+      readCacheRepos(q->reposDirectory(), sourceRepos, modules);
+      q->sortModules(modules);
+    }
+
+    updateIndexes();
+
+    if((!sourceRepos.empty() || !modules.empty()) && !writeBinaryIndex(binaryIndexPath(), sourceRepos, modules))
+      loadError = "Failed to write the cache index: " + binaryIndexPath();
+  }
+
+  //################################################################################################
+  //! Read the source repos and modules from JSON written by exportJSON, false if it has no modules.
+  bool loadJSON(const std::string& path)
+  {
+    nlohmann::json j = tp_utils::readJSONFile(path);
+
+    auto modulesJ = j.is_object()?j.find("modules"):j.end();
+    if(!j.is_object() || modulesJ==j.end() || !modulesJ->is_array())
+      return false;
+
+    sourceRepos.clear();
+    if(auto i=j.find("sourceRepos"); i!=j.end() && i->is_array())
+      for(const auto& jj : *i)
+        if(jj.is_string())
+          sourceRepos.push_back(jj);
+
+    modules.clear();
+    for(const auto& jj : *modulesJ)
+      modules.emplace_back().loadState(jj);
+
+    return true;
+  }
+};
+
+//##################################################################################################
+Cache::Cache(const std::string& cacheDirectory):
+  d(new Private(this, cacheDirectory))
+{
+  d->load();
+}
+
+//##################################################################################################
+Cache::~Cache()
+{
+  delete d;
+}
+
+//##################################################################################################
+const std::string& Cache::loadError() const
+{
+  return d->loadError;
+}
+
+//##################################################################################################
+const std::string& Cache::cacheDirectory() const
+{
+  return d->cacheDirectory;
+}
+
+//##################################################################################################
+std::string Cache::reposDirectory() const
+{
+  return tp_utils::pathAppend(d->cacheDirectory, "repos");
+}
+
+//##################################################################################################
+std::string Cache::indexPath() const
+{
+  return d->binaryIndexPath();
+}
+
+//##################################################################################################
+std::string Cache::exportPath() const
+{
+  return d->exportPath();
+}
+
+//##################################################################################################
+bool Cache::setSourceRepos(const std::vector<std::string>& sourceRepos)
+{
+  d->sourceRepos = sourceRepos;
+  return d->save();
+}
+
+//##################################################################################################
+const std::vector<std::string>& Cache::sourceRepos() const
+{
+  return d->sourceRepos;
+}
+
+//##################################################################################################
+bool Cache::setModules(const std::vector<Module>& modules)
+{
+  d->modules = modules;
+  d->updateIndexes();
+  return d->save();
+}
+
+//##################################################################################################
+const std::vector<Module>& Cache::modules() const
+{
+  return d->modules;
+}
+
+//##################################################################################################
+bool Cache::exportJSON(const std::string& path) const
+{
+  nlohmann::json j;
+
+  j["sourceRepos"] = nlohmann::json::array();
+  for(const auto& sourceRepo : d->sourceRepos)
+    j["sourceRepos"].push_back(sourceRepo);
+
+  j["modules"] = nlohmann::json::array();
+  for(const auto& module : d->modules)
+    j["modules"].push_back(module.saveState());
+
+  return tp_utils::writeJSONFile(path.empty()?d->exportPath():path, j, 2);
+}
+
+//##################################################################################################
+bool Cache::importJSON(const std::string& path)
+{
+  if(!tp_utils::exists(path) || !d->loadJSON(path))
+    return false;
+
+  d->updateIndexes();
+  return d->save();
+}
+
+//##################################################################################################
+Module Cache::module(const tp_utils::StringID& name) const
+{
+  if(auto m=findModule(name); m)
+    return *m;
+  return {};
+}
+
+//##################################################################################################
+const Module* Cache::findModule(const tp_utils::StringID& name) const
+{
+  if(auto id=d->graph.id(name); id!=ModuleGraph::invalidID)
+    return &d->modules.at(id);
+  return nullptr;
+}
+
+//##################################################################################################
+const ModuleGraph& Cache::graph() const
+{
+  return d->graph;
+}
+
+//##################################################################################################
+const ModuleSearchIndex& Cache::searchIndex() const
+{
+  return d->searchIndex;
+}
+
+//##################################################################################################
+bool Cache::isDependency(const tp_utils::StringID& name, const tp_utils::StringID& of) const
+{
+  return d->graph.isDependency(d->graph.id(name), d->graph.id(of));
+}
+
+//##################################################################################################
+bool Cache::sortModules(std::vector<Module>& modules, std::vector<tp_utils::StringID>* cycle) const
+{
+  ModuleGraph graph(modules);
+
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> cycleIDs;
+  bool sorted = graph.sortOrder(order, &cycleIDs);
+
+  if(cycle)
+    for(auto id : cycleIDs)
+      cycle->push_back(graph.name(id));
+
+  std::vector<Module> modulesOld;
+  modulesOld.swap(modules);
+  modules.reserve(modulesOld.size());
+  for(auto id : order)
+    modules.push_back(std::move(modulesOld[id]));
+
+  return sorted;
+}
+
+//##################################################################################################
+std::unordered_set<tp_utils::StringID> Cache::dependencyClosure(const std::unordered_set<tp_utils::StringID>& names) const
+{
+  std::unordered_set<tp_utils::StringID> result;
+
+  std::vector<uint32_t> ids;
+  ids.reserve(names.size());
+  for(const auto& name : names)
+  {
+    if(auto id=d->graph.id(name); id!=ModuleGraph::invalidID)
+      ids.push_back(id);
+    else
+      result.insert(name);
+  }
+
+  for(auto id : d->graph.closure(ids))
+  {
+    result.insert(d->graph.name(id));
+
+    // Dependencies that are not in the cache can't be followed but are still needed.
+    for(const auto& dep : d->modules.at(id).dependencies)
+      if(d->graph.id(dep) == ModuleGraph::invalidID)
+        result.insert(dep);
+  }
+
+  return result;
+}
+
+//##################################################################################################
+std::vector<tp_utils::StringID> Cache::dependents(const tp_utils::StringID& name, bool transitive) const
+{
+  std::vector<tp_utils::StringID> result;
+
+  auto id = d->graph.id(name);
+  if(id == ModuleGraph::invalidID)
+    return result;
+
+  if(transitive)
+  {
+    for(auto dependent : d->graph.dependentClosure({id}))
+      if(dependent != id)
+        result.push_back(d->graph.name(dependent));
+  }
+  else
+  {
+    for(auto dependent : d->graph.dependents(id))
+      result.push_back(d->graph.name(dependent));
+  }
+
+  return result;
+}
+
+//##################################################################################################
+std::vector<tp_utils::StringID> Cache::sortDependencies(const std::unordered_set<tp_utils::StringID>& dependencies) const
+{
+  std::vector<uint32_t> ids;
+  std::vector<tp_utils::StringID> result;
+  ids.reserve(dependencies.size());
+  result.reserve(dependencies.size());
+
+  for(const auto& dep : dependencies)
+    if(auto id=d->graph.id(dep); id!=ModuleGraph::invalidID)
+      ids.push_back(id);
+
+  std::sort(ids.begin(), ids.end());
+  for(auto id : ids)
+    result.push_back(d->graph.name(id));
+
+  for(const auto& dep : dependencies)
+    if(d->graph.id(dep) == ModuleGraph::invalidID)
+      result.push_back(dep);
+
+  return result;
+}
+
+}
@@ -0,0 +1,513 @@
+#include "general_configurator_core/CommandLine.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/ModuleGraph.h"
+#include "general_configurator_core/UpdateCache.h"
+#include "general_configurator_core/Generate.h"
+#include "general_configurator_core/BatchGenerate.h"
+
+#include "tp_utils/Progress.h"
+#include "tp_utils/FileUtils.h"
+
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <map>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+const char* usage =
+    "Usage: general_configurator <command> [options]\n"
+    "\n"
+    "Commands:\n"
+    "  update-cache [--source <url>]... [--incremental] [--metadata] [--jobs <n>] [--tp-update]\n"
+    "      Clone the source repos and their submodules and rebuild the index.\n"
+    "      If no sources are given the sources from the last update are used.\n"
+    "  generate --template <name> --root <path> --prefix <prefix> --suffix <suffix> [--library <name>]...\n"
+    "  generate --manifest <jobs.json> [--jobs <n>]\n"
+    "      Generate one app, or every app in a manifest, and print a report.\n"
+    "  sort-submodules <submodules.pri>...\n"
+    "      Sort existing submodules.pri files so that dependencies come first.\n"
+    "  deps <module>...\n"
+    "      Print the direct dependencies and dependents of modules.\n"
+    "  closure <module>...\n"
+    "      Print modules and all of their dependencies in build order.\n"
+    "  export-index [<index.json>]\n"
+    "      Write the cache index as JSON, by default to index.export.json in the cache directory.\n"
+    "  import-index [<index.json>]\n"
+    "      Replace the cache index with JSON written by export-index, by default index.export.json.\n"
+    "  help\n"
+    "\n"
+    "Common options:\n"
+    "  --cache <path>  The cache directory, defaults to the one used by the GUI.\n";
+
+//##################################################################################################
+const std::unordered_set<std::string> commands
+{
+  "update-cache",
+  "generate",
+  "sort-submodules",
+  "deps",
+  "closure",
+  "export-index",
+  "import-index",
+  "help",
+  "--help"
+};
+
+//##################################################################################################
+//! Options that are followed by a value.
+const std::unordered_set<std::string> valueOptions
+{
+  "--cache",
+  "--source",
+  "--jobs",
+  "--template",
+  "--root",
+  "--prefix",
+  "--suffix",
+  "--library",
+  "--manifest"
+};
+
+//##################################################################################################
+const std::unordered_set<std::string> flagOptions
+{
+  "--incremental",
+  "--metadata",
+  "--tp-update"
+};
+
+//##################################################################################################
+//! Prints the messages of a progress to stderr as they are added.
+/*!
+The commands run for minutes, without this the output of git and tpUpdate would only be seen in the
+errors at the end.
+*/
+class ProgressPrinter
+{
+  TP_NONCOPYABLE(ProgressPrinter);
+public:
+  //################################################################################################
+  ProgressPrinter():
+    progress([this]{poll(); return true;})
+  {
+
+  }
+
+  //################################################################################################
+  //! Print the messages that have been added since the last call.
+  void print()
+  {
+    m_lastPrint = std::chrono::steady_clock::now();
+
+    auto messages = progress.allMessages();
+    for(; m_printed<messages.size(); m_printed++)
+    {
+      const auto& message = messages.at(m_printed);
+      std::cerr << std::string(message.indentation*2, ' ') << message.message << '\n';
+    }
+    std::cerr.flush();
+  }
+
+  tp_utils::Progress progress;
+
+private:
+  //################################################################################################
+  //! Progress only hands out a copy of every message, so polls print at most every 100ms.
+  void poll()
+  {
+    if(std::chrono::steady_clock::now() - m_lastPrint >= std::chrono::milliseconds(100))
+      print();
+  }
+
+  size_t m_printed{0};
+  std::chrono::steady_clock::time_point m_lastPrint;
+};
+
+//##################################################################################################
+struct Arguments
+{
+  std::string command;
+  std::vector<std::string> positional;
+  std::multimap<std::string, std::string> options;
+
+  //################################################################################################
+  bool has(const std::string& name) const
+  {
+    return options.find(name) != options.end();
+  }
+
+  //################################################################################################
+  std::string value(const std::string& name, const std::string& defaultValue=std::string()) const
+  {
+    auto i = options.find(name);
+    return (i==options.end())?defaultValue:i->second;
+  }
+
+  //################################################################################################
+  std::vector<std::string> values(const std::string& name) const
+  {
+    std::vector<std::string> result;
+    auto range = options.equal_range(name);
+    for(auto i=range.first; i!=range.second; ++i)
+      result.push_back(i->second);
+    return result;
+  }
+};
+
+//##################################################################################################
+bool parseArguments(int argc, char* argv[], Arguments& arguments)
+{
+  if(argc<2)
+    return false;
+
+  arguments.command = argv[1];
+  for(int i=2; i<argc; i++)
+  {
+    std::string arg = argv[i];
+    if(tpContains(valueOptions, arg))
+    {
+      if(i+1>=argc)
+      {
+        std::cerr << "Missing value for: " << arg << std::endl;
+        return false;
+      }
+      arguments.options.emplace(arg, argv[++i]);
+    }
+    else if(tpContains(flagOptions, arg))
+      arguments.options.emplace(arg, std::string());
+    else if(arg.compare(0, 2, "--") == 0)
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return false;
+    }
+    else
+      arguments.positional.push_back(arg);
+  }
+
+  return true;
+}
+
+//##################################################################################################
+bool parseCount(const std::string& text, size_t& count)
+{
+  const char* end = text.data() + text.size();
+  if(auto [ptr, ec] = std::from_chars(text.data(), end, count); text.empty() || ec != std::errc() || ptr != end)
+  {
+    std::cerr << "Expected a number but got: " << text << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//##################################################################################################
+nlohmann::json toJSON(const std::vector<tp_utils::StringID>& names)
+{
+  nlohmann::json j = nlohmann::json::array();
+  for(const auto& name : names)
+    j.push_back(name.toString());
+  return j;
+}
+
+//##################################################################################################
+int64_t elapsedMS(std::chrono::steady_clock::time_point start)
+{
+  return int64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+//##################################################################################################
+//! Add the success flag and the errors of the progress to the result.
+int finish(nlohmann::json& j, bool success, const tp_utils::Progress* progress)
+{
+  if(progress && !success)
+    j["error"] = progress->errorMessage();
+
+  j["success"] = success;
+  return success?0:1;
+}
+
+//##################################################################################################
+int updateCacheCommand(Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  UpdateCacheParams params;
+  params.incremental = arguments.has("--incremental");
+  params.cloneMode = arguments.has("--metadata")?CloneMode::Metadata:CloneMode::Full;
+  params.useTpUpdate = arguments.has("--tp-update");
+  if(arguments.has("--jobs") && !parseCount(arguments.value("--jobs"), params.maxParallelClones))
+    return 2;
+
+  if(auto sources = arguments.values("--source"); !sources.empty() && !cache.setSourceRepos(sources))
+  {
+    std::cerr << "Failed to write the cache index: " << cache.indexPath() << std::endl;
+    return 1;
+  }
+
+  if(cache.sourceRepos().empty())
+  {
+    std::cerr << "No source repos, pass at least one --source." << std::endl;
+    return 2;
+  }
+
+  std::cerr << "Updating cache: " << cache.cacheDirectory() << std::endl;
+  auto start = std::chrono::steady_clock::now();
+
+  ProgressPrinter printer;
+  bool success = updateCache(cache, &printer.progress, params);
+  printer.print();
+
+  j["cacheDirectory"] = cache.cacheDirectory();
+  j["moduleCount"] = cache.modules().size();
+  j["elapsedMS"] = elapsedMS(start);
+  return finish(j, success, &printer.progress);
+}
+
+//##################################################################################################
+int generateCommand(const Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  std::vector<BatchJob> jobs;
+
+  if(arguments.has("--manifest"))
+  {
+    std::string error;
+    if(!loadBatchManifest(arguments.value("--manifest"), jobs, error))
+    {
+      std::cerr << error << std::endl;
+      return 2;
+    }
+  }
+  else
+  {
+    auto& job = jobs.emplace_back();
+    job.templateModule = arguments.value("--template");
+    job.rootPath = arguments.value("--root");
+    job.prefix = arguments.value("--prefix");
+    job.suffix = arguments.value("--suffix");
+    for(const auto& library : arguments.values("--library"))
+      job.libraries.insert(library);
+
+    if(job.templateModule.toString().empty() || job.rootPath.empty() || job.prefix.empty() || job.suffix.empty())
+    {
+      std::cerr << "generate needs --template, --root, --prefix and --suffix, or --manifest." << std::endl;
+      return 2;
+    }
+  }
+
+  BatchParams params;
+  if(arguments.has("--jobs") && !parseCount(arguments.value("--jobs"), params.maxParallelJobs))
+    return 2;
+
+  std::cerr << "Generating " << jobs.size() << " apps." << std::endl;
+  auto start = std::chrono::steady_clock::now();
+
+  ProgressPrinter printer;
+  std::vector<BatchJobResult> results;
+  bool success = generateBatch(cache, jobs, params, &printer.progress, results);
+  printer.print();
+
+  for(const auto& result : results)
+    if(!result.success)
+      std::cerr << "Failed: " << result.appPath << " " << result.error << std::endl;
+
+  j = batchReport(jobs, results);
+  j["elapsedMS"] = elapsedMS(start);
+  return finish(j, success, nullptr);
+}
+
+//##################################################################################################
+int sortSubmodulesCommand(const Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  if(arguments.positional.empty())
+  {
+    std::cerr << "sort-submodules needs at least one submodules.pri path." << std::endl;
+    return 2;
+  }
+
+  bool success=true;
+  j["files"] = nlohmann::json::array();
+  for(const auto& path : arguments.positional)
+  {
+    nlohmann::json jj;
+    jj["path"] = path;
+
+    auto subdirs = cache.sortDependencies(parseSubmodules(path));
+    std::string submodules = subdirs.empty()?std::string():generateSubmodules(std::string(), subdirs);
+    bool written = !submodules.empty() && tp_utils::writeTextFile(path, submodules);
+    if(!written)
+    {
+      std::cerr << "Failed to sort: " << path << std::endl;
+      success = false;
+    }
+
+    jj["success"] = written;
+    jj["subdirs"] = toJSON(subdirs);
+    j["files"].push_back(jj);
+  }
+
+  return finish(j, success, nullptr);
+}
+
+//##################################################################################################
+int depsCommand(const Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  const auto& graph = cache.graph();
+
+  bool success=true;
+  j["modules"] = nlohmann::json::object();
+  for(const auto& name : arguments.positional)
+  {
+    auto id = graph.id(name);
+    if(id == ModuleGraph::invalidID)
+    {
+      std::cerr << "Unknown module: " << name << std::endl;
+      success = false;
+      continue;
+    }
+
+    std::vector<tp_utils::StringID> dependencies;
+    for(auto dependency : graph.dependencies(id))
+      dependencies.push_back(graph.name(dependency));
+
+    std::vector<tp_utils::StringID> dependents;
+    for(auto dependent : graph.dependents(id))
+      dependents.push_back(graph.name(dependent));
+
+    nlohmann::json jj;
+    jj["type"] = cache.findModule(name)->type;
+    jj["dependencies"] = toJSON(dependencies);
+    jj["dependents"] = toJSON(dependents);
+    j["modules"][name] = jj;
+  }
+
+  return finish(j, success, nullptr);
+}
+
+//##################################################################################################
+int closureCommand(const Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  std::unordered_set<tp_utils::StringID> names;
+  for(const auto& name : arguments.positional)
+    names.insert(name);
+
+  auto closure = cache.sortDependencies(cache.dependencyClosure(names));
+
+  std::vector<tp_utils::StringID> missing;
+  for(const auto& name : closure)
+    if(!cache.findModule(name))
+      missing.push_back(name);
+
+  for(const auto& name : missing)
+    std::cerr << "Unknown module: " << name.toString() << std::endl;
+
+  j["closure"] = toJSON(closure);
+  j["missing"] = toJSON(missing);
+  return finish(j, missing.empty(), nullptr);
+}
+
+//##################################################################################################
+int exportIndexCommand(const Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  if(arguments.positional.size()>1)
+  {
+    std::cerr << "export-index takes at most one path." << std::endl;
+    return 2;
+  }
+
+  std::string path = arguments.positional.empty()?std::string():arguments.positional.front();
+  bool success = cache.exportJSON(path);
+  if(!success)
+    std::cerr << "Failed to export the index." << std::endl;
+
+  j["path"] = path.empty()?cache.exportPath():path;
+  return finish(j, success, nullptr);
+}
+
+//##################################################################################################
+int importIndexCommand(Cache& cache, const Arguments& arguments, nlohmann::json& j)
+{
+  if(arguments.positional.size()>1)
+  {
+    std::cerr << "import-index takes at most one path." << std::endl;
+    return 2;
+  }
+
+  std::string path = arguments.positional.empty()?cache.exportPath():arguments.positional.front();
+  bool success = cache.importJSON(path);
+  if(!success)
+    std::cerr << "Failed to import the index: " << path << std::endl;
+
+  j["path"] = path;
+  j["moduleCount"] = cache.modules().size();
+  return finish(j, success, nullptr);
+}
+
+}
+
+//##################################################################################################
+bool isCommandLine(int argc, char* argv[])
+{
+  return argc>=2 && tpContains(commands, std::string(argv[1]));
+}
+
+//##################################################################################################
+int runCommandLine(int argc, char* argv[], const std::string& defaultCacheDirectory)
+{
+  Arguments arguments;
+  if(!parseArguments(argc, argv, arguments))
+  {
+    std::cerr << usage;
+    return 2;
+  }
+
+  if(arguments.command == "help" || arguments.command == "--help")
+  {
+    std::cout << usage;
+    return 0;
+  }
+
+  if(!tpContains(commands, arguments.command))
+  {
+    std::cerr << usage;
+    return 2;
+  }
+
+  nlohmann::json result;
+  int ret=2;
+  {
+    Cache cache(arguments.value("--cache", defaultCacheDirectory));
+    if(!cache.loadError().empty())
+      std::cerr << cache.loadError() << std::endl;
+
+    if(arguments.command == "update-cache")
+      ret = updateCacheCommand(cache, arguments, result);
+
+    else if(arguments.command == "generate")
+      ret = generateCommand(cache, arguments, result);
+
+    else if(arguments.command == "sort-submodules")
+      ret = sortSubmodulesCommand(cache, arguments, result);
+
+    else if(arguments.command == "deps")
+      ret = depsCommand(cache, arguments, result);
+
+    else if(arguments.command == "closure")
+      ret = closureCommand(cache, arguments, result);
+
+    else if(arguments.command == "export-index")
+      ret = exportIndexCommand(cache, arguments, result);
+
+    else if(arguments.command == "import-index")
+      ret = importIndexCommand(cache, arguments, result);
+  }
+
+  if(!result.is_null())
+    std::cout << result.dump(2) << std::endl;
+
+  return ret;
+}
+
+}
@@ -0,0 +1,221 @@
+#include "general_configurator_core/FetchSubmodules.h"
+#include "general_configurator_core/UpdateCache.h"
+#include "general_configurator_core/GitUtils.h"
+
+#include "tp_utils/Progress.h"
+#include "tp_utils/FileUtils.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+//! Fetch the repos, progress is reported as (doneBefore+done)/total so waves add up.
+bool fetchRepos(const std::string& directory,
+                const std::vector<FetchRepo>& repos,
+                const FetchParams& params,
+                tp_utils::Progress* progress,
+                size_t doneBefore,
+                size_t total)
+{
+  struct RepoState
+  {
+    GitCommands commands;
+    bool fromLocalRepo{false};
+    bool succeeded{false};
+  };
+
+  std::vector<RepoState> states(repos.size());
+  size_t done=0;
+  bool failed=false;
+
+  auto output = [&](const std::string& line){progress->addMessage(line);};
+
+  auto startClone = [&](const FetchRepo& repo, RepoState& state)
+  {
+    progress->addMessage("Cloning: " + repo.url);
+    state.commands = GitCommands::clone(directory, repo.url, repo.name, params.cloneMode, params.timeoutMS);
+    state.fromLocalRepo = false;
+  };
+
+  // Called as each git command finishes, moves each repo on to its next command.
+  runProcesses(repos.size(), params.maxParallelFetches, [&](size_t i, const ProcessResult* previous, ProcessParams& next)
+  {
+    const auto& repo = repos.at(i);
+    auto& state = states.at(i);
+
+    if(!previous)
+    {
+      // Once a repo has failed the others that are running finish but no new ones are started.
+      if(failed && !params.continueOnError)
+        return false;
+
+      std::string localPath = params.localReposDirectory.empty()?std::string():tp_utils::pathAppend(params.localReposDirectory, repo.name);
+      if(repo.exists)
+      {
+        progress->addMessage("Updating: " + repo.name);
+        state.commands = GitCommands::pull(tp_utils::pathAppend(directory, repo.name), params.timeoutMS);
+      }
+      else if(!localPath.empty() && tp_utils::exists(localPath) && repoCloneMode(localPath) == CloneMode::Full)
+      {
+        progress->addMessage("Cloning from local repo: " + localPath);
+        state.commands = GitCommands::cloneLocal(directory, localPath, repo.name, repo.url, params.timeoutMS);
+        state.fromLocalRepo = true;
+      }
+      else
+        startClone(repo, state);
+    }
+
+    if(state.commands.next(previous, next, output))
+      return true;
+
+    if(state.fromLocalRepo && state.commands.exitCode() != 0 && previous && !previous->cancelled)
+    {
+      progress->addMessage("Failed to clone from local repo: " + repo.name);
+      tp_utils::rm(tp_utils::pathAppend(directory, repo.name), TPRecursive::Yes);
+      startClone(repo, state);
+      if(state.commands.next(nullptr, next, output))
+        return true;
+    }
+
+    done++;
+    progress->setProgress(float(doneBefore+done)/float(std::max(size_t(1), total)));
+
+    if(int ret = state.commands.exitCode(); ret != 0)
+    {
+      progress->addError("Failed to " + std::string(repo.exists?"update: ":"clone: ") + repo.name);
+      progress->addError("Return code: " + std::to_string(ret));
+      failed = true;
+    }
+    else
+    {
+      state.succeeded = true;
+      if(!repo.exists && !state.fromLocalRepo && state.commands.usedMode() != params.cloneMode)
+        progress->addMessage("Metadata clone not supported, made a full clone of: " + repo.name);
+    }
+
+    return false;
+  }, [&](size_t, const std::string& line, bool)
+  {
+    progress->addMessage(line);
+  }, [&]
+  {
+    return progress->shouldStop();
+  });
+
+  return std::all_of(states.begin(), states.end(), [](const auto& state){return state.succeeded;});
+}
+
+}
+
+//##################################################################################################
+bool fetchRepos(const std::string& directory,
+                const std::vector<FetchRepo>& repos,
+                const FetchParams& params,
+                tp_utils::Progress* progress)
+{
+  return fetchRepos(directory, repos, params, progress, 0, repos.size());
+}
+
+//##################################################################################################
+bool fetchSubmodules(const std::string& directory,
+                     const std::vector<std::string>& rootModules,
+                     const FetchParams& params,
+                     tp_utils::Progress* progress)
+{
+  auto modulePath = [&](const std::string& name)
+  {
+    return tp_utils::pathAppend(directory, name);
+  };
+
+  std::unordered_set<std::string> seen(rootModules.begin(), rootModules.end());
+  std::vector<std::string> frontier(rootModules.begin(), rootModules.end());
+  size_t fetched=0;
+
+  // One step is shared by all of the waves so that deep trees don't add a step per level.
+  tp_utils::Progress* p=nullptr;
+
+  while(!frontier.empty())
+  {
+    std::vector<std::string> next;
+    std::vector<FetchRepo> missing;
+
+    for(const auto& parent : frontier)
+    {
+      std::string parentPrefix;
+      bool parentPrefixRead=false;
+
+      for(const auto& subdirID : parseSubmodules(tp_utils::pathAppend(modulePath(parent), "submodules.pri")))
+      {
+        auto subdir = submoduleRepoName(subdirID.toString());
+        if(!seen.insert(subdir).second)
+          continue;
+
+        next.push_back(subdir);
+        if(tp_utils::exists(modulePath(subdir)))
+          continue;
+
+        auto& repo = missing.emplace_back();
+        repo.name = subdir;
+
+        if(auto i=params.urls.find(subdir); i!=params.urls.end())
+        {
+          repo.url = i->second;
+          continue;
+        }
+
+        // Submodules are expected to live next to the module that references them.
+        if(!parentPrefixRead)
+        {
+          parentPrefixRead = true;
+          parentPrefix = readGitRemoteURL(modulePath(parent));
+          if(auto pos=parentPrefix.rfind(parent); pos<parentPrefix.size())
+            parentPrefix = parentPrefix.substr(0, pos);
+          else
+            parentPrefix.clear();
+        }
+
+        if(parentPrefix.empty())
+        {
+          progress->addError("Failed to find a URL for " + subdir + " referenced by " + parent);
+          return false;
+        }
+
+        repo.url = parentPrefix + subdir + ".git";
+      }
+    }
+
+    if(!missing.empty())
+    {
+      // The total grows as each wave finds more submodules, what has been fetched stays counted.
+      size_t total = fetched + missing.size();
+      std::string description = "Fetching " + std::to_string(missing.size()) + " submodules";
+      if(!p)
+        p = progress->addChildStep(description, 1.0f);
+      else
+        p->setProgress(float(fetched)/float(total), description);
+
+      if(!fetchRepos(directory, missing, params, p, fetched, total))
+      {
+        progress->addError("Failed to fetch submodules.");
+        return false;
+      }
+      fetched += missing.size();
+    }
+
+    if(!params.recursive)
+      break;
+
+    frontier.swap(next);
+  }
+
+  progress->addMessage("Fetched " + std::to_string(fetched) + " submodules.");
+  return true;
+}
+
+}
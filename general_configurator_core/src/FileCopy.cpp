@@ -0,0 +1,351 @@
+#include "general_configurator_core/FileCopy.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+#endif
+
+namespace general_configurator
+{
+
+namespace
+{
+
+#ifndef _WIN32
+
+//##################################################################################################
+std::string errorString(const std::string& what, const std::string& path)
+{
+  return what + ": " + path + " (" + std::strerror(errno) + ")";
+}
+
+//##################################################################################################
+//! Close a file descriptor when it goes out of scope.
+struct FD
+{
+  int fd{-1};
+
+  //################################################################################################
+  FD(int fd_):
+    fd(fd_)
+  {
+
+  }
+
+  //################################################################################################
+  ~FD()
+  {
+    if(fd != -1)
+      ::close(fd);
+  }
+};
+
+//##################################################################################################
+bool copyData(int in, int out, size_t size)
+{
+#ifdef __linux__
+  {
+    size_t remaining = size;
+    while(remaining>0)
+    {
+      ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+      if(n<0)
+      {
+        // Not supported between these files, fall back to a plain copy of what is left.
+        if(errno==EXDEV || errno==ENOSYS || errno==EINVAL || errno==EOPNOTSUPP)
+          break;
+        return false;
+      }
+
+      // The file shrunk while it was being copied.
+      if(n==0)
+        return true;
+
+      remaining -= size_t(n);
+    }
+
+    if(remaining==0)
+      return true;
+  }
+#else
+  (void)size;
+#endif
+
+  std::vector<char> buffer(1<<20);
+  for(;;)
+  {
+    ssize_t n = ::read(in, buffer.data(), buffer.size());
+    if(n<0)
+    {
+      if(errno==EINTR)
+        continue;
+      return false;
+    }
+
+    if(n==0)
+      return true;
+
+    for(ssize_t written=0; written<n;)
+    {
+      ssize_t w = ::write(out, buffer.data()+written, size_t(n-written));
+      if(w<0)
+      {
+        if(errno==EINTR)
+          continue;
+        return false;
+      }
+      written += w;
+    }
+  }
+}
+
+//##################################################################################################
+bool copyFile(const std::string& from, const std::string& to, const TreeEntry& entry, std::string& error, CopyTreeStats& stats)
+{
+  stats.files++;
+  stats.bytes += entry.size;
+
+#ifdef __APPLE__
+  if(::clonefile(from.c_str(), to.c_str(), 0) == 0)
+  {
+    stats.clonedFiles++;
+    return true;
+  }
+#endif
+
+  FD in(::open(from.c_str(), O_RDONLY | O_CLOEXEC));
+  if(in.fd == -1)
+  {
+    error = errorString("Failed to open", from);
+    return false;
+  }
+
+  FD out(::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, entry.mode));
+  if(out.fd == -1)
+  {
+    error = errorString("Failed to create", to);
+    return false;
+  }
+
+#ifdef FICLONE
+  if(::ioctl(out.fd, FICLONE, in.fd) == 0)
+  {
+    stats.clonedFiles++;
+    return true;
+  }
+#endif
+
+  if(!copyData(in.fd, out.fd, entry.size))
+  {
+    error = errorString("Failed to copy", from);
+    return false;
+  }
+
+  return true;
+}
+
+#endif
+
+}
+
+//##################################################################################################
+bool listTree(const std::string& directory,
+              const std::unordered_set<std::string>& skip,
+              std::vector<TreeEntry>& entries,
+              std::string& error)
+{
+  std::vector<std::string> directories{std::string()};
+  while(!directories.empty())
+  {
+    std::string relative = directories.back();
+    directories.pop_back();
+    std::string path = relative.empty()?directory:tp_utils::pathAppend(directory, relative);
+    size_t first = entries.size();
+
+#ifdef _WIN32
+    for(const auto& filePath : tp_utils::listFiles(path, {}))
+    {
+      auto name = tp_utils::filename(filePath);
+      if(tpContains(skip, name))
+        continue;
+
+      auto& entry = entries.emplace_back();
+      entry.path = relative.empty()?name:tp_utils::pathAppend(relative, name);
+      entry.type = TreeEntry::Type::File;
+    }
+
+    for(const auto& directoryPath : tp_utils::listDirectories(path))
+    {
+      auto name = tp_utils::filename(directoryPath);
+      if(tpContains(skip, name))
+        continue;
+
+      auto& entry = entries.emplace_back();
+      entry.path = relative.empty()?name:tp_utils::pathAppend(relative, name);
+      entry.type = TreeEntry::Type::Directory;
+    }
+#else
+    DIR* dir = ::opendir(path.c_str());
+    if(!dir)
+    {
+      error = errorString("Failed to open directory", path);
+      return false;
+    }
+
+    std::vector<std::string> names;
+    while(dirent* entry = ::readdir(dir))
+    {
+      std::string name = entry->d_name;
+      if(name != "." && name != ".." && !tpContains(skip, name))
+        names.push_back(name);
+    }
+    ::closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for(const auto& name : names)
+    {
+      std::string entryPath = tp_utils::pathAppend(path, name);
+
+      struct stat st;
+      if(::lstat(entryPath.c_str(), &st) != 0)
+      {
+        error = errorString("Failed to stat", entryPath);
+        return false;
+      }
+
+      TreeEntry::Type type;
+      if(S_ISDIR(st.st_mode))
+        type = TreeEntry::Type::Directory;
+      else if(S_ISLNK(st.st_mode))
+        type = TreeEntry::Type::Symlink;
+      else if(S_ISREG(st.st_mode))
+        type = TreeEntry::Type::File;
+      else
+        continue;
+
+      auto& entry = entries.emplace_back();
+      entry.path = relative.empty()?name:tp_utils::pathAppend(relative, name);
+      entry.type = type;
+      entry.mode = uint32_t(st.st_mode & 07777);
+      entry.size = size_t(st.st_size);
+    }
+#endif
+
+    // Push in reverse so that the directories are listed in name order.
+    for(size_t i=entries.size(); i>first; i--)
+      if(const auto& entry = entries.at(i-1); entry.type == TreeEntry::Type::Directory)
+        directories.push_back(entry.path);
+  }
+
+  return true;
+}
+
+//##################################################################################################
+bool copyTree(const std::string& from,
+              const std::string& to,
+              const std::unordered_set<std::string>& skip,
+              std::string& error,
+              CopyTreeStats* stats)
+{
+  CopyTreeStats localStats;
+  CopyTreeStats& s = stats?*stats:localStats;
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<TreeEntry> entries;
+  if(!listTree(from, skip, entries, error))
+    return false;
+
+  if(!tp_utils::mkdir(to, TPCreateFullPath::Yes))
+  {
+    error = "Failed to create directory: " + to;
+    return false;
+  }
+
+  for(const auto& entry : entries)
+  {
+    std::string src = tp_utils::pathAppend(from, entry.path);
+    std::string dst = tp_utils::pathAppend(to, entry.path);
+
+#ifdef _WIN32
+    if(entry.type == TreeEntry::Type::Directory)
+    {
+      if(!tp_utils::mkdir(dst, TPCreateFullPath::No))
+      {
+        error = "Failed to create directory: " + dst;
+        return false;
+      }
+    }
+    else
+    {
+      if(!tp_utils::copyFile(src, dst))
+      {
+        error = "Failed to copy: " + src;
+        return false;
+      }
+      s.files++;
+    }
+#else
+    switch(entry.type)
+    {
+    case TreeEntry::Type::Directory:
+    {
+      if(::mkdir(dst.c_str(), entry.mode) != 0 && errno != EEXIST)
+      {
+        error = errorString("Failed to create directory", dst);
+        return false;
+      }
+      break;
+    }
+
+    case TreeEntry::Type::Symlink:
+    {
+      std::string target(entry.size+1, '\0');
+      ssize_t n = ::readlink(src.c_str(), target.data(), target.size());
+      if(n<0)
+      {
+        error = errorString("Failed to read link", src);
+        return false;
+      }
+      target.resize(size_t(n));
+
+      if(::symlink(target.c_str(), dst.c_str()) != 0)
+      {
+        error = errorString("Failed to create link", dst);
+        return false;
+      }
+      break;
+    }
+
+    case TreeEntry::Type::File:
+    {
+      if(!copyFile(src, dst, entry, error, s))
+        return false;
+      break;
+    }
+    }
+#endif
+  }
+
+  s.elapsedMS = int64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+  return true;
+}
+
+}
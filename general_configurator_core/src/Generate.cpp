@@ -0,0 +1,339 @@
+#include "general_configurator_core/Generate.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/FetchSubmodules.h"
+#include "general_configurator_core/FileCopy.h"
+#include "general_configurator_core/GitUtils.h"
+#include "general_configurator_core/Process.h"
+#include "general_configurator_core/ReplaceNames.h"
+
+#include "tp_utils/Progress.h"
+#include "tp_utils/FileUtils.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+std::string usableCacheCheckout(const Cache& cache, const Module& module, std::string& reason)
+{
+  std::string cachedPath = tp_utils::pathAppend(cache.reposDirectory(), module.name.toString());
+
+  if(!tp_utils::exists(cachedPath))
+    reason = "it is not in the cache";
+  else if(repoCloneMode(cachedPath) != CloneMode::Full)
+    reason = "the cache only has a metadata clone";
+  else if(module.gitHead.empty() || readGitHead(cachedPath) != module.gitHead)
+    reason = "the cached copy is stale";
+  else
+    return cachedPath;
+
+  return std::string();
+}
+
+//##################################################################################################
+bool generateApp(const Cache& cache,
+                 const tp_utils::StringID& templateModuleId,
+                 const std::string& rootPath,
+                 const std::string& modulePrefix,
+                 const std::string& moduleSuffix,
+                 const std::unordered_set<tp_utils::StringID>& selectedLibraries,
+                 const std::unordered_set<tp_utils::StringID>& allDependencies,
+                 tp_utils::Progress* progress,
+                 const GenerateParams& params)
+{
+  const Module* templateModulePtr = cache.findModule(templateModuleId);
+  if(!templateModulePtr)
+  {
+    progress->addError("Failed to find template module: " + templateModuleId.toString());
+    return false;
+  }
+  const Module& templateModule = *templateModulePtr;
+
+  std::string moduleName = generateModuleName(modulePrefix,
+                                              moduleSuffix);
+
+  std::string topLevelPathString = generateTopLevelPathString(rootPath,
+                                                              modulePrefix,
+                                                              moduleSuffix);
+
+  std::string appPathString = generateAppPathString(rootPath,
+                                                    modulePrefix,
+                                                    moduleSuffix);
+
+  std::string gitRepoString = generateGitRepoString(templateModule.gitRepoPrefix,
+                                                    modulePrefix,
+                                                    moduleSuffix);
+
+
+  //-- Create the module directory -----------------------------------------------------------------
+  {
+    // Like git clone refuse to write into a directory that has something in it, everything in the
+    // directory is deleted if the copy from the cache fails.
+    if(tp_utils::exists(appPathString))
+    {
+      std::vector<TreeEntry> entries;
+      std::string error;
+      if(!listTree(appPathString, {}, entries, error))
+      {
+        progress->addError(error);
+        return false;
+      }
+
+      if(!entries.empty())
+      {
+        progress->addError("The module directory is not empty: " + appPathString);
+        return false;
+      }
+    }
+
+    progress->addMessage("Create app module path: " + appPathString);
+    if(!tp_utils::mkdir(appPathString, TPCreateFullPath::Yes))
+    {
+      progress->addError("Failed to create module directory!");
+      return false;
+    }
+    progress->setProgress(0.05f);
+  }
+
+  //-- Copy the template from the cache ------------------------------------------------------------
+  // The template is normally checked out in the cache by updateCache, copying it from there avoids a
+  // network clone. Metadata clones only contain the .pri files so they can't be used.
+  bool copiedFromCache=false;
+  {
+    std::string reason;
+    std::string cachedPath = params.templateSnapshot.empty()?usableCacheCheckout(cache, templateModule, reason):params.templateSnapshot;
+
+    if(reason.empty())
+    {
+      progress->addMessage("Copy template from: " + cachedPath);
+
+      std::string error;
+      CopyTreeStats stats;
+      if(copyTree(cachedPath, appPathString, {".git"}, error, &stats))
+      {
+        copiedFromCache = true;
+        progress->addMessage("Copied " + std::to_string(stats.files) + " files, " +
+                             std::to_string(stats.bytes) + " bytes, " +
+                             std::to_string(stats.clonedFiles) + " as reflinks in " +
+                             std::to_string(stats.elapsedMS) + "ms.");
+      }
+      else
+      {
+        progress->addMessage("Failed to copy template: " + error);
+
+        // The directory was empty before the copy so this only removes what the copy created.
+        tp_utils::rm(appPathString, TPRecursive::Yes);
+        tp_utils::mkdir(appPathString, TPCreateFullPath::Yes);
+      }
+    }
+    else
+      progress->addMessage("Cloning template because " + reason + ".");
+
+    progress->setProgress(0.2f);
+  }
+
+  // Forward the output of git and tpUpdate to the progress log and kill them if we are cancelled.
+  ProcessObserver observer;
+  observer.output = [&](const std::string& line){progress->addMessage(line);};
+  observer.shouldStop = [&]{return progress->shouldStop() || (params.cancel && *params.cancel);};
+
+  //-- Clone the template into the module directory ------------------------------------------------
+  if(!copiedFromCache)
+  {
+    progress->addMessage("Clone template: " + templateModule.gitRepoURL);
+    auto result = runProcess({{"git", "clone", templateModule.gitRepoURL, "."}, appPathString}, observer);
+    if(!result.success())
+    {
+      progress->addError("Failed to clone: " + templateModule.gitRepoURL);
+      progress->addError(result.errorMessage());
+      return false;
+    }
+    progress->setProgress(0.2f);
+  }
+
+  //-- Delete the .git directory -------------------------------------------------------------------
+  if(!copiedFromCache)
+  {
+    std::string gitDir = tp_utils::pathAppend(appPathString, ".git");
+    progress->addMessage("Delete .git directory: " + gitDir);
+    if(!tp_utils::rm(gitDir, TPRecursive::Yes))
+    {
+      progress->addError("Failed to delete .git directory!");
+      return false;
+    }
+    progress->setProgress(0.25f);
+  }
+
+  //-- Rename files and replace module names -------------------------------------------------------
+  {
+    progress->addMessage("Rename files and replace module names.");
+
+    std::vector<ReplaceRule> rules;
+    rules.push_back({templateModule.name.toString(), moduleName});
+    rules.push_back({templateModule.suffix(), moduleSuffix});
+
+    std::string error;
+    ReplaceStats stats;
+    if(!replaceNames(appPathString, rules, error, &stats, params.maxRewriteThreads))
+    {
+      progress->addError("Failed to rename module: " + error);
+      return false;
+    }
+
+    progress->addMessage("Listed files in " + std::to_string(stats.listMS) + "ms.");
+    progress->addMessage("Scanned " + std::to_string(stats.filesScanned) + " files, " +
+                         std::to_string(stats.bytesScanned) + " bytes, changed " +
+                         std::to_string(stats.filesChanged) + " and skipped " +
+                         std::to_string(stats.binaryFiles) + " binary files in " +
+                         std::to_string(stats.replaceMS) + "ms.");
+    progress->addMessage("Renamed " + std::to_string(stats.pathsRenamed) + " paths in " +
+                         std::to_string(stats.renameMS) + "ms.");
+    progress->setProgress(0.35f);
+  }
+
+  //-- Generate submodules.pri ---------------------------------------------------------------------
+  {
+    progress->addMessage("Generate submodules.");
+
+    std::string submodules = generateSubmodules(cache, moduleName, allDependencies);
+    std::string submodulesFile = tp_utils::pathAppend(appPathString, "submodules.pri");
+    tp_utils::writeTextFile(submodulesFile, submodules);
+
+    progress->setProgress(0.4f);
+  }
+
+  //-- Generate dependencies.pri -------------------------------------------------------------------
+  {
+    progress->addMessage("Generate dependencies.");
+
+    std::string dependencies;
+
+    for(const auto& m : selectedLibraries)
+      dependencies += "DEPENDENCIES += " + m.toString() + "\n";
+
+    dependencies += "\nINCLUDEPATHS += " + moduleName + "/inc\n";
+
+    std::string submodulesFile = tp_utils::pathAppend(appPathString, "dependencies.pri");
+    tp_utils::writeTextFile(submodulesFile, dependencies);
+
+    progress->setProgress(0.45f);
+  }
+
+  //-- Git Init ------------------------------------------------------------------------------------
+  {
+    progress->addMessage("Git init.");
+
+    if(auto result = runProcess({{"git", "init"}, appPathString}, observer); !result.success())
+    {
+      progress->addError("Failed to init.");
+      progress->addError(result.errorMessage());
+      return false;
+    }
+
+    progress->setProgress(0.5f);
+  }
+
+  //-- Git Remote Add ------------------------------------------------------------------------------
+  {
+    progress->addMessage("Git remote add.");
+
+    if(auto result = runProcess({{"git", "remote", "add", "origin", gitRepoString}, appPathString}, observer);
+       !result.success())
+    {
+      progress->addError("Failed to add git remote: " + gitRepoString);
+      progress->addError(result.errorMessage());
+      return false;
+    }
+
+    progress->setProgress(0.55f);
+  }
+
+  //-- Copy top level files ------------------------------------------------------------------------
+  {
+    auto copy = [&](const std::string& srcName, const std::string& dstName)
+    {
+      auto from = tp_utils::pathAppend(appPathString, srcName);
+      auto to = tp_utils::pathAppend(topLevelPathString, dstName);
+      tp_utils::copyFile(from, to);
+    };
+
+    copy("Makefile.top", "Makefile");
+    copy("CMakeFiles.top", "CMakeFiles.txt");
+    copy(moduleSuffix + ".pro", moduleSuffix + ".pro");
+  }
+
+  //-- tpUpdate ------------------------------------------------------------------------------------
+  if(params.useTpUpdate)
+  {
+    progress->addMessage("Run tpUpdate.");
+
+    if(auto result = runProcess({{"tpUpdate"}, topLevelPathString}, observer); !result.success())
+    {
+      progress->addError("Failed to run tpUpdate.");
+      progress->addError(result.errorMessage());
+      return false;
+    }
+
+    progress->setProgress(1.0f);
+  }
+
+  //-- Fetch dependencies --------------------------------------------------------------------------
+  else
+  {
+    progress->addMessage("Fetch dependencies.");
+
+    // The generated submodules.pri already lists every dependency so there is no need to recurse.
+    FetchParams fetchParams;
+    fetchParams.maxParallelFetches = params.maxParallelFetches;
+    fetchParams.recursive = false;
+    if(params.cloneFromCache)
+      fetchParams.localReposDirectory = cache.reposDirectory();
+    for(const auto& m : cache.modules())
+      if(!m.gitRepoURL.empty())
+        fetchParams.urls[m.name.toString()] = m.gitRepoURL;
+
+    auto p = progress->addChildStep("Fetch dependencies", 1.0f);
+    if(!fetchSubmodules(topLevelPathString, {moduleName}, fetchParams, p))
+    {
+      progress->addError("Failed to fetch dependencies.");
+      return false;
+    }
+
+    progress->setProgress(1.0f);
+  }
+
+  return true;
+}
+
+//##################################################################################################
+std::string generateSubmodules(const Cache& cache,
+                               const std::string& moduleName,
+                               const std::unordered_set<tp_utils::StringID>& allDependencies)
+{
+  return generateSubmodules(moduleName, cache.sortDependencies(allDependencies));
+}
+
+//##################################################################################################
+std::string generateSubmodules(const std::string& moduleName,
+                               const std::vector<tp_utils::StringID>& sortedDependencies)
+{
+  std::string submodules;
+  std::string previousPrefix;
+
+  for(const auto& m : sortedDependencies)
+  {
+    std::string prefix = extractPrefix(m.toString());
+    if(!previousPrefix.empty() && previousPrefix != prefix)
+      submodules += "\n";
+    previousPrefix.swap(prefix);
+
+    submodules += "SUBDIRS += " + m.toString() + "\n";
+  }
+
+  submodules += "\n";
+
+  if(!moduleName.empty())
+    submodules += "SUBDIRS += " + moduleName + "\n\n";
+
+  return submodules;
+}
+}
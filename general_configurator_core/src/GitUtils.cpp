@@ -0,0 +1,439 @@
+#include "general_configurator_core/GitUtils.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <cctype>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+std::string trim(const std::string& s)
+{
+  auto b = s.find_first_not_of(" \t\r\n");
+  if(b == std::string::npos)
+    return {};
+  auto e = s.find_last_not_of(" \t\r\n");
+  return s.substr(b, e-b+1);
+}
+
+//##################################################################################################
+bool isAbsolutePath(const std::string& path)
+{
+  return (!path.empty() && (path.front()=='/' || path.front()=='\\')) || (path.size()>1 && path[1]==':');
+}
+
+//##################################################################################################
+//! Worktrees keep their refs in the main git directory, this is pointed to by the commondir file.
+std::string commonDirectory(const std::string& gitDir)
+{
+  std::string commonDir = trim(tp_utils::readTextFile(tp_utils::pathAppend(gitDir, "commondir")));
+  if(commonDir.empty())
+    return gitDir;
+
+  if(isAbsolutePath(commonDir))
+    return commonDir;
+
+  return tp_utils::pathAppend(gitDir, commonDir);
+}
+
+//##################################################################################################
+std::string toLower(std::string s)
+{
+  for(auto& c : s)
+    c = char(std::tolower(static_cast<unsigned char>(c)));
+  return s;
+}
+
+//##################################################################################################
+std::string expandHome(const std::string& path)
+{
+  if(path.compare(0, 2, "~/") == 0)
+    if(const char* home = std::getenv("HOME"); home)
+      return tp_utils::pathAppend(home, path.substr(2));
+  return path;
+}
+
+//##################################################################################################
+//! Parse the value part of a config line, handling quotes, escapes and inline comments.
+std::string parseConfigValue(const std::string& raw)
+{
+  std::string value;
+  bool quoted=false;
+  size_t pendingSpace=0;
+  for(size_t i=0; i<raw.size(); i++)
+  {
+    char c = raw[i];
+    if(!quoted && (c=='#' || c==';'))
+      break;
+
+    if(!quoted && (c==' ' || c=='\t'))
+    {
+      if(!value.empty())
+        pendingSpace++;
+      continue;
+    }
+
+    value.append(pendingSpace, ' ');
+    pendingSpace=0;
+
+    if(c=='"')
+      quoted = !quoted;
+    else if(c=='\\' && i+1<raw.size())
+    {
+      switch(char e = raw[++i]; e)
+      {
+      case 'n': value += '\n'; break;
+      case 't': value += '\t'; break;
+      case 'b': if(!value.empty()) value.pop_back(); break;
+      default:  value += e; break;
+      }
+    }
+    else
+      value += c;
+  }
+  return value;
+}
+
+//##################################################################################################
+using ConfigClosure = std::function<void(const std::string& section,
+                                         const std::string& subsection,
+                                         const std::string& key,
+                                         const std::string& value)>;
+
+//##################################################################################################
+void parseGitConfig(const std::string& path, const ConfigClosure& closure, int depth=0)
+{
+  // Git limits include depth to 10 to catch include loops.
+  if(depth>10)
+    return;
+
+  std::string data = tp_utils::readTextFile(path);
+
+  std::string section;
+  std::string subsection;
+
+  size_t pos=0;
+  while(pos<data.size())
+  {
+    // Join lines that end in a backslash.
+    std::string line;
+    for(;;)
+    {
+      size_t end = data.find('\n', pos);
+      if(end == std::string::npos)
+        end = data.size();
+      std::string part = data.substr(pos, end-pos);
+      pos = end+1;
+      if(!part.empty() && part.back()=='\r')
+        part.pop_back();
+      if(!part.empty() && part.back()=='\\' && pos<data.size())
+      {
+        part.pop_back();
+        line += part;
+        continue;
+      }
+      line += part;
+      break;
+    }
+
+    line = trim(line);
+    if(line.empty() || line.front()=='#' || line.front()==';')
+      continue;
+
+    if(line.front()=='[')
+    {
+      auto close = line.rfind(']');
+      if(close == std::string::npos)
+        continue;
+
+      std::string header = line.substr(1, close-1);
+      subsection.clear();
+      if(auto q=header.find('"'); q!=std::string::npos)
+      {
+        section = toLower(trim(header.substr(0, q)));
+        for(size_t i=q+1; i<header.size() && header[i]!='"'; i++)
+        {
+          if(header[i]=='\\' && i+1<header.size())
+            i++;
+          subsection += header[i];
+        }
+      }
+      else if(auto d=header.find('.'); d!=std::string::npos)
+      {
+        // Deprecated [section.subsection] syntax, the subsection is lower case.
+        section = toLower(trim(header.substr(0, d)));
+        subsection = toLower(trim(header.substr(d+1)));
+      }
+      else
+        section = toLower(trim(header));
+
+      line = trim(line.substr(close+1));
+      if(line.empty() || line.front()=='#' || line.front()==';')
+        continue;
+    }
+
+    std::string key;
+    std::string value;
+    if(auto e=line.find('='); e!=std::string::npos)
+    {
+      key = toLower(trim(line.substr(0, e)));
+      value = parseConfigValue(line.substr(e+1));
+    }
+    else
+    {
+      key = toLower(line);
+      value = "true";
+    }
+
+    if(section=="include" && subsection.empty() && key=="path")
+    {
+      std::string includePath = expandHome(value);
+      if(!isAbsolutePath(includePath))
+        includePath = tp_utils::pathAppend(tp_utils::directoryName(path), includePath);
+      parseGitConfig(includePath, closure, depth+1);
+      continue;
+    }
+
+    closure(section, subsection, key, value);
+  }
+}
+
+//##################################################################################################
+std::string resolveRef(const std::string& gitDir, const std::string& ref)
+{
+  for(const auto& dir : {gitDir, commonDirectory(gitDir)})
+  {
+    std::string hash = trim(tp_utils::readTextFile(tp_utils::pathAppend(dir, ref)));
+    if(!hash.empty())
+      return hash;
+  }
+
+  std::vector<std::string> lines;
+  tpSplit(lines, tp_utils::readTextFile(tp_utils::pathAppend(commonDirectory(gitDir), "packed-refs")), '\n', TPSplitBehavior::SkipEmptyParts);
+  for(const auto& line : lines)
+  {
+    if(line.front()=='#' || line.front()=='^')
+      continue;
+
+    if(auto i=line.find(' '); i!=std::string::npos && trim(line.substr(i+1))==ref)
+      return line.substr(0, i);
+  }
+
+  return {};
+}
+
+}
+
+//##################################################################################################
+std::string repoNameFromURL(const std::string& url)
+{
+  std::string name = url;
+  while(!name.empty() && (name.back()=='/' || name.back()=='\\'))
+    name.pop_back();
+
+  if(auto i=name.find_last_of("/\\:"); i!=std::string::npos)
+    name = name.substr(i+1);
+
+  if(name.size()>4 && name.compare(name.size()-4, 4, ".git")==0)
+    name.resize(name.size()-4);
+
+  return name;
+}
+
+//##################################################################################################
+std::string gitDirectory(const std::string& repoPath)
+{
+  std::string gitDir = tp_utils::pathAppend(repoPath, ".git");
+
+  // In a worktree or a repo with a separate git dir .git is a file containing "gitdir: <path>".
+  std::string contents = trim(tp_utils::readTextFile(gitDir));
+  if(contents.compare(0, 7, "gitdir:") == 0)
+  {
+    std::string path = trim(contents.substr(7));
+    return isAbsolutePath(path)?path:tp_utils::pathAppend(repoPath, path);
+  }
+
+  return gitDir;
+}
+
+//##################################################################################################
+std::string readGitConfigValue(const std::string& repoPath,
+                               const std::string& section,
+                               const std::string& subsection,
+                               const std::string& key)
+{
+  std::string lowerSection = toLower(section);
+  std::string lowerKey = toLower(key);
+
+  std::string result;
+  auto closure = [&](const std::string& s, const std::string& ss, const std::string& k, const std::string& v)
+  {
+    if(s==lowerSection && ss==subsection && k==lowerKey)
+      result = v;
+  };
+
+  // Worktrees share the config of the main repo and can add their own in config.worktree.
+  std::string gitDir = gitDirectory(repoPath);
+  parseGitConfig(tp_utils::pathAppend(commonDirectory(gitDir), "config"), closure);
+  parseGitConfig(tp_utils::pathAppend(gitDir, "config.worktree"), closure);
+
+  return result;
+}
+
+//##################################################################################################
+std::string readGitRemoteURL(const std::string& repoPath, const std::string& remote)
+{
+  return readGitConfigValue(repoPath, "remote", remote, "url");
+}
+
+//##################################################################################################
+CloneMode repoCloneMode(const std::string& repoPath)
+{
+  std::string gitDir = gitDirectory(repoPath);
+  if(tp_utils::exists(tp_utils::pathAppend(gitDir, "shallow")) ||
+     tp_utils::exists(tp_utils::pathAppend(tp_utils::pathAppend(gitDir, "info"), "sparse-checkout")))
+    return CloneMode::Metadata;
+  return CloneMode::Full;
+}
+
+//##################################################################################################
+GitCommands GitCommands::clone(const std::string& directory,
+                               const std::string& url,
+                               const std::string& name,
+                               CloneMode mode,
+                               int64_t timeoutMS)
+{
+  GitCommands commands;
+  commands.m_timeoutMS = timeoutMS;
+
+  Command fullClone{directory, {"clone", url, name}};
+  if(mode == CloneMode::Metadata)
+  {
+    std::string repoPath = tp_utils::pathAppend(directory, name);
+    commands.m_commands.push_back({directory, {"clone", "--depth", "1", "--filter=blob:none", "--no-checkout", url, name}});
+    commands.m_commands.push_back({repoPath, {"sparse-checkout", "set", "--no-cone", "/*.pri"}});
+    commands.m_commands.push_back({repoPath, {"checkout"}});
+    commands.m_usedMode = CloneMode::Metadata;
+    commands.m_fallback.push_back(fullClone);
+    commands.m_fallbackCleanup = repoPath;
+  }
+  else
+    commands.m_commands.push_back(fullClone);
+
+  return commands;
+}
+
+//##################################################################################################
+GitCommands GitCommands::cloneLocal(const std::string& directory,
+                                    const std::string& localPath,
+                                    const std::string& name,
+                                    const std::string& url,
+                                    int64_t timeoutMS)
+{
+  GitCommands commands;
+  commands.m_timeoutMS = timeoutMS;
+
+  std::string repoPath = tp_utils::pathAppend(directory, name);
+  commands.m_commands.push_back({directory, {"clone", "--local", localPath, name}});
+  commands.m_commands.push_back({repoPath, {"remote", "set-url", "origin", url}});
+
+  // The local copy may be behind the remote and only has the branches that were checked out in it,
+  // fetch the real remote and bring the checked out branch up to date with it.
+  commands.m_commands.push_back({repoPath, {"fetch", "--prune", "origin"}});
+  commands.m_commands.push_back({repoPath, {"merge", "--ff-only", "@{upstream}"}});
+  return commands;
+}
+
+//##################################################################################################
+GitCommands GitCommands::pull(const std::string& repoPath, int64_t timeoutMS)
+{
+  GitCommands commands;
+  commands.m_timeoutMS = timeoutMS;
+
+  if(tp_utils::exists(tp_utils::pathAppend(gitDirectory(repoPath), "shallow")))
+  {
+    commands.m_commands.push_back({repoPath, {"fetch", "--depth", "1"}});
+    commands.m_commands.push_back({repoPath, {"reset", "--hard", "FETCH_HEAD"}});
+  }
+  else
+    commands.m_commands.push_back({repoPath, {"pull", "--ff-only"}});
+
+  return commands;
+}
+
+//##################################################################################################
+bool GitCommands::next(const ProcessResult* previous,
+                       ProcessParams& params,
+                       const std::function<void(const std::string&)>& output)
+{
+  if(previous)
+  {
+    if(!previous->error.empty())
+    {
+      if(output)
+        output(previous->error);
+      m_exitCode = -1;
+    }
+    else
+    {
+      if(previous->timedOut && output)
+        output("Timed out: git " + m_commands.at(m_next-1).arguments.front());
+      m_exitCode = previous->exitCode;
+    }
+
+    if(!previous->success())
+    {
+      if(m_fallback.empty())
+        return false;
+
+      tp_utils::rm(m_fallbackCleanup, TPRecursive::Yes);
+      if(previous->cancelled)
+        return false;
+
+      m_commands.swap(m_fallback);
+      m_fallback.clear();
+      m_next = 0;
+      m_usedMode = CloneMode::Full;
+    }
+  }
+
+  if(m_next>=m_commands.size())
+    return false;
+
+  const auto& command = m_commands.at(m_next++);
+  params.arguments = {"git"};
+  params.arguments.insert(params.arguments.end(), command.arguments.begin(), command.arguments.end());
+  params.workingDirectory = command.workingDirectory;
+  params.timeoutMS = m_timeoutMS;
+  return true;
+}
+
+//##################################################################################################
+int GitCommands::exitCode() const
+{
+  return m_exitCode;
+}
+
+//##################################################################################################
+CloneMode GitCommands::usedMode() const
+{
+  return m_usedMode;
+}
+
+//##################################################################################################
+std::string readGitHead(const std::string& repoPath)
+{
+  std::string gitDir = gitDirectory(repoPath);
+  std::string head = trim(tp_utils::readTextFile(tp_utils::pathAppend(gitDir, "HEAD")));
+
+  if(head.compare(0, 4, "ref:") == 0)
+    return resolveRef(gitDir, trim(head.substr(4)));
+
+  return head;
+}
+
+}
@@ -1,8 +1,10 @@
-#include "general_configurator/Globals.h"
+#include "general_configurator_core/Globals.h"
 
 #include "tp_utils/FileUtils.h"
 #include "tp_utils/JSONUtils.h"
 
+#include <algorithm>
+
 namespace general_configurator
 {
 
@@ -17,6 +19,53 @@ std::string extractPrefix(const std::string& name)
   return {};
 }
 
+//##################################################################################################
+std::string moduleTypeToString(ModuleType type)
+{
+  switch(type)
+  {
+  case ModuleType::Unknown: return "unknown";
+  case ModuleType::Lib:     return "lib";
+  case ModuleType::Subdirs: return "subdirs";
+  case ModuleType::App:     return "app";
+  }
+  return "unknown";
+}
+
+//##################################################################################################
+ModuleType moduleTypeFromString(const std::string& type)
+{
+  if(type == "lib")
+    return ModuleType::Lib;
+
+  if(type == "subdirs")
+    return ModuleType::Subdirs;
+
+  if(type == "app")
+    return ModuleType::App;
+
+  return ModuleType::Unknown;
+}
+
+//##################################################################################################
+std::string cloneModeToString(CloneMode mode)
+{
+  switch(mode)
+  {
+  case CloneMode::Full:     return "full";
+  case CloneMode::Metadata: return "metadata";
+  }
+  return "full";
+}
+
+//##################################################################################################
+CloneMode cloneModeFromString(const std::string& mode)
+{
+  if(mode == "metadata")
+    return CloneMode::Metadata;
+  return CloneMode::Full;
+}
+
 //##################################################################################################
 std::string Module::prefix() const
 {
@@ -41,6 +90,12 @@ std::string Module::suffix() const
   return result;
 }
 
+//##################################################################################################
+ModuleType Module::moduleType() const
+{
+  return moduleTypeFromString(type);
+}
+
 //##################################################################################################
 nlohmann::json Module::saveState() const
 {
@@ -51,10 +106,19 @@ nlohmann::json Module::saveState() const
   j["type"] = type;
   j["gitRepoURL"] = gitRepoURL;
   j["gitRepoPrefix"] = gitRepoPrefix;
+  j["gitHead"] = gitHead;
+  j["cloneMode"] = cloneModeToString(cloneMode);
 
-  j["dependencies"] = nlohmann::json::array();
+  // Sorted so that the saved index does not depend on hash order.
+  std::vector<std::string> sortedDependencies;
+  sortedDependencies.reserve(dependencies.size());
   for(const auto& dependency : dependencies)
-    j["dependencies"].push_back(dependency.toString());
+    sortedDependencies.push_back(dependency.toString());
+  std::sort(sortedDependencies.begin(), sortedDependencies.end());
+
+  j["dependencies"] = nlohmann::json::array();
+  for(const auto& dependency : sortedDependencies)
+    j["dependencies"].push_back(dependency);
 
   return j;
 }
@@ -67,6 +131,8 @@ void Module::loadState(const nlohmann::json& j)
   type = TPJSONString(j, "type");
   gitRepoURL = TPJSONString(j, "gitRepoURL");
   gitRepoPrefix = TPJSONString(j, "gitRepoPrefix");
+  gitHead = TPJSONString(j, "gitHead");
+  cloneMode = cloneModeFromString(TPJSONString(j, "cloneMode"));
 
   dependencies.clear();
   if(auto i=j.find("dependencies"); i!=j.end() && i->is_array())
@@ -75,13 +141,6 @@ void Module::loadState(const nlohmann::json& j)
         dependencies.insert(jj.get<std::string>());
 }
 
-//##################################################################################################
-int runCommand(const std::string& workingDirectory, const std::string& command)
-{
-  std::string s = "cd " + workingDirectory + " && " + command;
-  return std::system(s.c_str());
-}
-
 //##################################################################################################
 std::string generateModuleName(const std::string& modulePrefix,
                                const std::string& moduleSuffix)
@@ -0,0 +1,174 @@
+#include "general_configurator_core/LibrarySelection.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/ModuleGraph.h"
+
+namespace general_configurator
+{
+
+//##################################################################################################
+void LibrarySelection::reset(const Cache& cache, const tp_utils::StringID& templateName)
+{
+  m_cache = &cache;
+
+  const auto& graph = cache.graph();
+  m_roots.assign(graph.size(), false);
+  m_required.assign(graph.size(), false);
+  m_counts.assign(graph.size(), 0);
+  m_missingCounts.clear();
+  m_selectedLibraries.clear();
+  m_allDependencies.clear();
+
+  std::vector<uint32_t> templateDependencies;
+  if(const Module* templateModule = cache.findModule(templateName); templateModule)
+    for(const auto& dependency : templateModule->dependencies)
+      if(auto id=graph.id(dependency); id!=ModuleGraph::invalidID)
+        templateDependencies.push_back(id);
+
+  for(auto id : graph.closure(templateDependencies))
+    m_required[id] = true;
+
+  for(auto id : templateDependencies)
+    addRoot(id, nullptr);
+}
+
+//##################################################################################################
+void LibrarySelection::check(uint32_t id, std::vector<uint32_t>* changed)
+{
+  if(id<m_roots.size())
+    addRoot(id, changed);
+}
+
+//##################################################################################################
+void LibrarySelection::uncheck(uint32_t id, std::vector<uint32_t>* changed)
+{
+  if(id>=m_roots.size() || m_required[id] || m_counts[id]==0)
+    return;
+
+  // Everything on a path from a picked library down to id is in the closure of that library, so the
+  // search can stop at modules that are not selected.
+  const auto& graph = m_cache->graph();
+  std::vector<uint32_t> stack{id};
+  std::unordered_set<uint32_t> visited{id};
+  std::vector<uint32_t> roots;
+  while(!stack.empty())
+  {
+    uint32_t i = stack.back();
+    stack.pop_back();
+
+    if(m_roots[i])
+      roots.push_back(i);
+
+    for(auto dependent : graph.dependents(i))
+      if(m_counts[dependent]>0 && visited.insert(dependent).second)
+        stack.push_back(dependent);
+  }
+
+  for(auto root : roots)
+    removeRoot(root, changed);
+}
+
+//##################################################################################################
+LibrarySelection::State LibrarySelection::state(uint32_t id) const
+{
+  if(id>=m_roots.size())
+    return State::Unchecked;
+
+  if(m_roots[id])
+    return State::Checked;
+
+  return m_counts[id]>0?State::Partial:State::Unchecked;
+}
+
+//##################################################################################################
+bool LibrarySelection::required(uint32_t id) const
+{
+  return id<m_required.size() && m_required[id];
+}
+
+//##################################################################################################
+const std::unordered_set<tp_utils::StringID>& LibrarySelection::selectedLibraries() const
+{
+  return m_selectedLibraries;
+}
+
+//##################################################################################################
+const std::unordered_set<tp_utils::StringID>& LibrarySelection::allDependencies() const
+{
+  return m_allDependencies;
+}
+
+//##################################################################################################
+void LibrarySelection::addRoot(uint32_t id, std::vector<uint32_t>* changed)
+{
+  if(m_roots[id])
+    return;
+
+  const auto& graph = m_cache->graph();
+  m_roots[id] = true;
+  m_selectedLibraries.insert(graph.name(id));
+  if(changed)
+    changed->push_back(id);
+
+  for(auto i : graph.closure({id}))
+  {
+    if(m_counts[i]++ != 0)
+      continue;
+
+    m_allDependencies.insert(graph.name(i));
+
+    // Dependencies that are not in the cache can't be followed but are still needed.
+    for(const auto& dependency : m_cache->modules().at(i).dependencies)
+      if(graph.id(dependency) == ModuleGraph::invalidID)
+        addDependency(dependency);
+
+    if(changed && i!=id)
+      changed->push_back(i);
+  }
+}
+
+//##################################################################################################
+void LibrarySelection::removeRoot(uint32_t id, std::vector<uint32_t>* changed)
+{
+  if(!m_roots[id])
+    return;
+
+  const auto& graph = m_cache->graph();
+  m_roots[id] = false;
+  m_selectedLibraries.erase(graph.name(id));
+  if(changed)
+    changed->push_back(id);
+
+  for(auto i : graph.closure({id}))
+  {
+    if(--m_counts[i] != 0)
+      continue;
+
+    m_allDependencies.erase(graph.name(i));
+
+    for(const auto& dependency : m_cache->modules().at(i).dependencies)
+      if(graph.id(dependency) == ModuleGraph::invalidID)
+        removeDependency(dependency);
+
+    if(changed && i!=id)
+      changed->push_back(i);
+  }
+}
+
+//##################################################################################################
+void LibrarySelection::addDependency(const tp_utils::StringID& name)
+{
+  if(m_missingCounts[name]++ == 0)
+    m_allDependencies.insert(name);
+}
+
+//##################################################################################################
+void LibrarySelection::removeDependency(const tp_utils::StringID& name)
+{
+  if(auto i=m_missingCounts.find(name); i!=m_missingCounts.end() && --i->second == 0)
+  {
+    m_missingCounts.erase(i);
+    m_allDependencies.erase(name);
+  }
+}
+
+}
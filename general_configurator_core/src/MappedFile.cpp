@@ -0,0 +1,50 @@
+#include "general_configurator_core/MappedFile.h"
+
+#include "tp_utils/FileUtils.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace general_configurator
+{
+
+//##################################################################################################
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+  m_buffer = tp_utils::readBinaryFile(path);
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd<0)
+    return;
+
+  struct stat st;
+  if(::fstat(fd, &st)==0 && st.st_size>0)
+  {
+    void* data = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data != MAP_FAILED)
+    {
+      m_data = static_cast<const char*>(data);
+      m_size = size_t(st.st_size);
+    }
+  }
+  ::close(fd);
+#endif
+}
+
+//##################################################################################################
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+  if(m_data)
+    ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+}
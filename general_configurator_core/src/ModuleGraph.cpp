@@ -0,0 +1,400 @@
+#include "general_configurator_core/ModuleGraph.h"
+
+#include <queue>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+//! The index of the lowest set bit, v must not be 0.
+uint32_t lowestSetBit(uint64_t v)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, v);
+  return uint32_t(index);
+#else
+  return uint32_t(__builtin_ctzll(v));
+#endif
+}
+
+}
+
+//##################################################################################################
+ModuleGraph::ModuleGraph(const std::vector<Module>& modules)
+{
+  const size_t n = modules.size();
+
+  m_ids.reserve(n);
+  m_names.reserve(n);
+  m_types.reserve(n);
+  m_prefixIDs.reserve(n);
+
+  std::unordered_map<std::string, uint32_t> prefixIDs;
+  for(size_t i=0; i<n; i++)
+  {
+    const auto& module = modules.at(i);
+    m_ids.emplace(module.name, uint32_t(i));
+    m_names.push_back(module.name);
+    m_types.push_back(module.moduleType());
+    m_prefixIDs.push_back(prefixIDs.emplace(module.prefix(), uint32_t(prefixIDs.size())).first->second);
+  }
+
+  std::vector<uint32_t> dependentCounts(n, 0);
+  m_dependencyOffsets.reserve(n+1);
+  for(size_t i=0; i<n; i++)
+  {
+    for(const auto& dep : modules.at(i).dependencies)
+    {
+      if(uint32_t j=id(dep); j!=invalidID && j!=i)
+      {
+        m_dependencies.push_back(j);
+        dependentCounts[j]++;
+      }
+    }
+    std::sort(m_dependencies.begin()+m_dependencyOffsets.back(), m_dependencies.end());
+    m_dependencyOffsets.push_back(uint32_t(m_dependencies.size()));
+  }
+
+  m_dependentOffsets.reserve(n+1);
+  for(size_t i=0; i<n; i++)
+    m_dependentOffsets.push_back(m_dependentOffsets.back() + dependentCounts[i]);
+
+  // Filling in id order leaves each dependent list sorted.
+  m_dependents.resize(m_dependencies.size());
+  std::vector<uint32_t> fill(m_dependentOffsets.begin(), m_dependentOffsets.end()-1);
+  for(uint32_t i=0; i<n; i++)
+    for(auto j : dependencies(i))
+      m_dependents[fill[j]++] = i;
+
+  buildClosure();
+}
+
+//##################################################################################################
+size_t ModuleGraph::size() const
+{
+  return m_names.size();
+}
+
+//##################################################################################################
+uint32_t ModuleGraph::id(const tp_utils::StringID& name) const
+{
+  if(auto i=m_ids.find(name); i!=m_ids.end())
+    return i->second;
+  return invalidID;
+}
+
+//##################################################################################################
+const tp_utils::StringID& ModuleGraph::name(uint32_t id) const
+{
+  return m_names.at(id);
+}
+
+//##################################################################################################
+ModuleType ModuleGraph::type(uint32_t id) const
+{
+  return m_types.at(id);
+}
+
+//##################################################################################################
+uint32_t ModuleGraph::prefixID(uint32_t id) const
+{
+  return m_prefixIDs.at(id);
+}
+
+//##################################################################################################
+ModuleGraph::IDs ModuleGraph::dependencies(uint32_t id) const
+{
+  return {m_dependencies.data()+m_dependencyOffsets[id], m_dependencies.data()+m_dependencyOffsets[id+1]};
+}
+
+//##################################################################################################
+ModuleGraph::IDs ModuleGraph::dependents(uint32_t id) const
+{
+  return {m_dependents.data()+m_dependentOffsets[id], m_dependents.data()+m_dependentOffsets[id+1]};
+}
+
+//##################################################################################################
+bool ModuleGraph::isDependency(uint32_t dependency, uint32_t of) const
+{
+  if(dependency>=size() || of>=size())
+    return false;
+
+  return m_closure[of*m_closureWords + dependency/64] & (uint64_t(1) << (dependency%64));
+}
+
+//##################################################################################################
+std::vector<uint32_t> ModuleGraph::closure(const std::vector<uint32_t>& ids) const
+{
+  std::vector<uint64_t> bits(m_closureWords, 0);
+  for(auto id : ids)
+  {
+    if(id>=size())
+      continue;
+
+    const uint64_t* row = m_closure.data() + id*m_closureWords;
+    for(size_t w=0; w<m_closureWords; w++)
+      bits[w] |= row[w];
+  }
+
+  std::vector<uint32_t> result;
+  for(size_t w=0; w<m_closureWords; w++)
+    for(uint64_t v=bits[w]; v; v&=v-1)
+      result.push_back(uint32_t(w*64 + lowestSetBit(v)));
+
+  return result;
+}
+
+//##################################################################################################
+std::vector<uint32_t> ModuleGraph::dependentClosure(const std::vector<uint32_t>& ids) const
+{
+  std::vector<bool> visited(size(), false);
+  std::vector<uint32_t> stack;
+  for(auto id : ids)
+    if(id<size())
+      stack.push_back(id);
+
+  std::vector<uint32_t> result;
+  while(!stack.empty())
+  {
+    uint32_t i = stack.back();
+    stack.pop_back();
+    for(auto j : dependents(i))
+    {
+      if(!visited[j])
+      {
+        visited[j] = true;
+        result.push_back(j);
+        stack.push_back(j);
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+//##################################################################################################
+bool ModuleGraph::sortOrder(std::vector<uint32_t>& order, std::vector<uint32_t>* cycle) const
+{
+  const size_t n = size();
+
+  if(cycle)
+    cycle->clear();
+
+  // First pass keeps id order where dependencies allow, this defines the prefix order.
+  std::vector<size_t> keys(n);
+  for(size_t i=0; i<n; i++)
+    keys[i] = i;
+  order = kahnOrder(keys);
+
+  // Second pass groups modules by prefix in the order that the prefixes were first seen.
+  {
+    std::vector<size_t> ranks(size(), n);
+    size_t nextRank=0;
+    for(size_t o=0; o<order.size(); o++)
+    {
+      uint32_t i = order.at(o);
+      size_t& rank = ranks[m_prefixIDs[i]];
+      if(rank == n)
+        rank = nextRank++;
+      keys[i] = rank*n + o;
+    }
+    order = kahnOrder(keys);
+  }
+
+  if(order.size() == n)
+    return true;
+
+  std::vector<bool> placed(n, false);
+  for(auto i : order)
+    placed[i] = true;
+
+  for(uint32_t i=0; i<n; i++)
+    if(!placed[i])
+      order.push_back(i);
+
+  // What is left are the cycles, everything that depends on them and anything sitting between two
+  // of them. Only the strongly connected components of more than one module are actual cycles, self
+  // dependencies are dropped when the graph is built. Found with Tarjan's algorithm.
+  std::vector<bool> inCycle(n, false);
+  {
+    std::vector<uint32_t> index(n, invalidID);
+    std::vector<uint32_t> lowLink(n, 0);
+    std::vector<bool> onStack(n, false);
+    std::vector<uint32_t> component;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    uint32_t nextIndex=0;
+
+    auto visit = [&](uint32_t i)
+    {
+      index[i] = nextIndex;
+      lowLink[i] = nextIndex;
+      nextIndex++;
+      component.push_back(i);
+      onStack[i] = true;
+      stack.emplace_back(i, m_dependencyOffsets[i]);
+    };
+
+    for(uint32_t root=0; root<n; root++)
+    {
+      if(placed[root] || index[root]!=invalidID)
+        continue;
+
+      visit(root);
+      while(!stack.empty())
+      {
+        auto& [i, e] = stack.back();
+        if(e<m_dependencyOffsets[i+1])
+        {
+          uint32_t j = m_dependencies[e++];
+          if(placed[j])
+            continue;
+
+          if(index[j] == invalidID)
+            visit(j);
+          else if(onStack[j])
+            lowLink[i] = std::min(lowLink[i], index[j]);
+          continue;
+        }
+
+        uint32_t done = i;
+        stack.pop_back();
+        if(!stack.empty())
+          lowLink[stack.back().first] = std::min(lowLink[stack.back().first], lowLink[done]);
+
+        if(lowLink[done] != index[done])
+          continue;
+
+        auto first = component.end();
+        do
+          --first;
+        while(*first != done);
+
+        bool cyclic = (component.end()-first)>1;
+        for(auto c=first; c!=component.end(); ++c)
+        {
+          onStack[*c] = false;
+          inCycle[*c] = cyclic;
+        }
+        component.erase(first, component.end());
+      }
+    }
+  }
+
+  if(cycle)
+    for(uint32_t i=0; i<n; i++)
+      if(inCycle[i])
+        cycle->push_back(i);
+
+  return false;
+}
+
+//##################################################################################################
+void ModuleGraph::buildClosure()
+{
+  const size_t n = size();
+  m_closureWords = (n+63)/64;
+  m_closure.assign(n*m_closureWords, 0);
+
+  for(size_t i=0; i<n; i++)
+    m_closure[i*m_closureWords + i/64] |= uint64_t(1) << (i%64);
+
+  // Visit dependencies before their dependents so that an acyclic graph is complete after a
+  // single pass, cycles just take a few extra passes to reach a fixed point.
+  std::vector<uint32_t> order;
+  order.reserve(n);
+  {
+    std::vector<bool> visited(n, false);
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for(uint32_t root=0; root<n; root++)
+    {
+      if(visited[root])
+        continue;
+
+      visited[root] = true;
+      stack.emplace_back(root, m_dependencyOffsets[root]);
+      while(!stack.empty())
+      {
+        auto& [i, e] = stack.back();
+        if(e<m_dependencyOffsets[i+1])
+        {
+          uint32_t j = m_dependencies[e++];
+          if(!visited[j])
+          {
+            visited[j] = true;
+            stack.emplace_back(j, m_dependencyOffsets[j]);
+          }
+        }
+        else
+        {
+          order.push_back(i);
+          stack.pop_back();
+        }
+      }
+    }
+  }
+
+  for(bool changed=true; changed;)
+  {
+    changed = false;
+    for(auto i : order)
+    {
+      uint64_t* row = m_closure.data() + i*m_closureWords;
+      for(auto j : dependencies(i))
+      {
+        const uint64_t* depRow = m_closure.data() + j*m_closureWords;
+        for(size_t w=0; w<m_closureWords; w++)
+        {
+          uint64_t v = row[w] | depRow[w];
+          if(v != row[w])
+          {
+            row[w] = v;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+//##################################################################################################
+std::vector<uint32_t> ModuleGraph::kahnOrder(const std::vector<size_t>& keys) const
+{
+  const size_t n = size();
+
+  std::vector<uint32_t> counts(n);
+  for(size_t i=0; i<n; i++)
+    counts[i] = m_dependencyOffsets[i+1] - m_dependencyOffsets[i];
+
+  // When more than one module is ready the one with the lowest key goes next.
+  auto greater = [&](uint32_t a, uint32_t b){return keys[a] > keys[b];};
+  std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(greater)> ready(greater);
+  for(uint32_t i=0; i<n; i++)
+    if(counts[i] == 0)
+      ready.push(i);
+
+  std::vector<uint32_t> order;
+  order.reserve(n);
+  while(!ready.empty())
+  {
+    uint32_t i = ready.top();
+    ready.pop();
+    order.push_back(i);
+    for(auto j : dependents(i))
+      if(--counts[j] == 0)
+        ready.push(j);
+  }
+
+  return order;
+}
+
+}
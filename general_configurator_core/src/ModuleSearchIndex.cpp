@@ -0,0 +1,202 @@
+#include "general_configurator_core/ModuleSearchIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+std::string toLower(std::string s)
+{
+  for(auto& c : s)
+    c = char(std::tolower(static_cast<unsigned char>(c)));
+  return s;
+}
+
+//##################################################################################################
+uint32_t trigramAt(const std::string& s, size_t i)
+{
+  return (uint32_t(static_cast<unsigned char>(s[i])) << 16) |
+         (uint32_t(static_cast<unsigned char>(s[i+1])) << 8) |
+          uint32_t(static_cast<unsigned char>(s[i+2]));
+}
+
+}
+
+//##################################################################################################
+bool ModuleQuery::empty() const
+{
+  return text.find_first_not_of(" \t\r\n") == std::string::npos && prefix.empty() && types.empty();
+}
+
+//##################################################################################################
+ModuleSearchIndex::ModuleSearchIndex(const std::vector<Module>& modules)
+{
+  const size_t n = modules.size();
+  m_lowerNames.reserve(n);
+  m_prefixIndexes.reserve(n);
+  m_moduleTypes.reserve(n);
+
+  std::vector<std::string> modulePrefixes;
+  modulePrefixes.reserve(n);
+  for(const auto& module : modules)
+  {
+    m_lowerNames.push_back(toLower(module.name.toString()));
+    m_moduleTypes.push_back(module.moduleType());
+    modulePrefixes.push_back(module.prefix());
+  }
+
+  m_prefixes = modulePrefixes;
+  std::sort(m_prefixes.begin(), m_prefixes.end());
+  m_prefixes.erase(std::unique(m_prefixes.begin(), m_prefixes.end()), m_prefixes.end());
+  for(const auto& prefix : modulePrefixes)
+    m_prefixIndexes.push_back(uint32_t(std::lower_bound(m_prefixes.begin(), m_prefixes.end(), prefix) - m_prefixes.begin()));
+
+  m_types = m_moduleTypes;
+  std::sort(m_types.begin(), m_types.end());
+  m_types.erase(std::unique(m_types.begin(), m_types.end()), m_types.end());
+
+  // Sorting (trigram, id) pairs groups the postings by trigram with the ids already in order.
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  for(uint32_t id=0; id<n; id++)
+  {
+    const auto& name = m_lowerNames.at(id);
+    for(size_t i=0; i+3<=name.size(); i++)
+      pairs.emplace_back(trigramAt(name, i), id);
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  m_postings.reserve(pairs.size());
+  for(const auto& [trigram, id] : pairs)
+  {
+    if(m_trigrams.empty() || m_trigrams.back() != trigram)
+    {
+      if(!m_trigrams.empty())
+        m_postingOffsets.push_back(uint32_t(m_postings.size()));
+      m_trigrams.push_back(trigram);
+    }
+    m_postings.push_back(id);
+  }
+  if(!m_trigrams.empty())
+    m_postingOffsets.push_back(uint32_t(m_postings.size()));
+}
+
+//##################################################################################################
+std::vector<uint32_t> ModuleSearchIndex::search(const ModuleQuery& query) const
+{
+  std::vector<std::string> terms;
+  {
+    const char* whitespace = " \t\r\n";
+    std::string text = toLower(query.text);
+    for(size_t b=text.find_first_not_of(whitespace); b!=std::string::npos; b=text.find_first_not_of(whitespace, b))
+    {
+      size_t e = text.find_first_of(whitespace, b);
+      terms.push_back(text.substr(b, e-b));
+      b = e;
+    }
+  }
+
+  uint32_t prefixIndex=0;
+  if(!query.prefix.empty())
+  {
+    auto i = std::lower_bound(m_prefixes.begin(), m_prefixes.end(), query.prefix);
+    if(i==m_prefixes.end() || *i!=query.prefix)
+      return {};
+    prefixIndex = uint32_t(i-m_prefixes.begin());
+  }
+
+  // Collect the posting lists of every trigram in the long terms, a missing trigram means no match.
+  std::vector<std::pair<const uint32_t*, const uint32_t*>> lists;
+  for(const auto& term : terms)
+  {
+    for(size_t i=0; i+3<=term.size(); i++)
+    {
+      auto list = postings(trigramAt(term, i));
+      if(list.first == list.second)
+        return {};
+      lists.push_back(list);
+    }
+  }
+
+  std::vector<uint32_t> candidates;
+  bool allCandidates = lists.empty();
+  if(!allCandidates)
+  {
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b)
+    {
+      return (a.second-a.first) < (b.second-b.first);
+    });
+
+    candidates.assign(lists.front().first, lists.front().second);
+    for(size_t l=1; l<lists.size() && !candidates.empty(); l++)
+    {
+      auto end = std::set_intersection(candidates.begin(), candidates.end(),
+                                       lists.at(l).first, lists.at(l).second,
+                                       candidates.begin());
+      candidates.erase(end, candidates.end());
+    }
+  }
+
+  auto matches = [&](uint32_t id)
+  {
+    if(!query.prefix.empty() && m_prefixIndexes.at(id) != prefixIndex)
+      return false;
+
+    if(!query.types.empty() && !tpContains(query.types, m_moduleTypes.at(id)))
+      return false;
+
+    // Trigrams only say that the parts of a term are in the name, not that they are contiguous.
+    const auto& name = m_lowerNames.at(id);
+    for(const auto& term : terms)
+      if(name.find(term) == std::string::npos)
+        return false;
+
+    return true;
+  };
+
+  std::vector<uint32_t> result;
+  if(allCandidates)
+  {
+    for(uint32_t id=0; id<m_lowerNames.size(); id++)
+      if(matches(id))
+        result.push_back(id);
+  }
+  else
+  {
+    for(auto id : candidates)
+      if(matches(id))
+        result.push_back(id);
+  }
+
+  return result;
+}
+
+//##################################################################################################
+const std::vector<std::string>& ModuleSearchIndex::prefixes() const
+{
+  return m_prefixes;
+}
+
+//##################################################################################################
+const std::vector<ModuleType>& ModuleSearchIndex::types() const
+{
+  return m_types;
+}
+
+//##################################################################################################
+std::pair<const uint32_t*, const uint32_t*> ModuleSearchIndex::postings(uint32_t trigram) const
+{
+  auto i = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+  if(i==m_trigrams.end() || *i!=trigram)
+    return {nullptr, nullptr};
+
+  size_t t = size_t(i-m_trigrams.begin());
+  return {m_postings.data()+m_postingOffsets.at(t), m_postings.data()+m_postingOffsets.at(t+1)};
+}
+
+}
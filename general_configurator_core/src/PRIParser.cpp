@@ -0,0 +1,445 @@
+#include "general_configurator_core/PRIParser.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+bool isSpace(char c)
+{
+  return c==' ' || c=='\t' || c=='\r';
+}
+
+//##################################################################################################
+std::string_view trim(std::string_view s)
+{
+  while(!s.empty() && isSpace(s.front()))
+    s.remove_prefix(1);
+  while(!s.empty() && isSpace(s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+//##################################################################################################
+bool isVariableChar(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c=='_' || c=='.';
+}
+
+//##################################################################################################
+//! Expand a value, a value that is just a reference to a variable expands to all of its values.
+void expandValues(std::string_view value, const PRIVariables& variables, std::vector<std::string>& result)
+{
+  std::string_view name;
+  if(value.size()>2 && value.compare(0, 2, "$$")==0)
+  {
+    name = value.substr(2);
+    if(name.size()>1 && name.front()=='{' && name.back()=='}')
+      name = name.substr(1, name.size()-2);
+  }
+
+  bool whole = !name.empty();
+  for(auto c : name)
+    whole = whole && isVariableChar(c);
+
+  if(whole)
+  {
+    if(auto v=variables.find(std::string(name)); v!=variables.end())
+      result.insert(result.end(), v->second.begin(), v->second.end());
+    return;
+  }
+
+  result.push_back(expandPRIValue(value, variables));
+}
+
+//##################################################################################################
+class Tokenizer
+{
+public:
+  //################################################################################################
+  Tokenizer(std::string_view data, const std::function<void(const PRIStatement&)>& closure):
+    m_data(data),
+    m_closure(closure)
+  {
+
+  }
+
+  //################################################################################################
+  void run()
+  {
+    while(m_pos<m_data.size())
+    {
+      skipSpace(true);
+      if(m_pos>=m_data.size())
+        break;
+
+      char c = m_data[m_pos];
+      if(c=='#')
+        skipComment();
+      else if(c=='}')
+      {
+        m_pos++;
+        if(!m_scopes.empty())
+          m_scopes.pop_back();
+        updateScope();
+      }
+      else
+        statement();
+    }
+  }
+
+private:
+  //################################################################################################
+  //! Skip spaces and escaped newlines, and plain newlines if newlines is true.
+  void skipSpace(bool newlines)
+  {
+    while(m_pos<m_data.size())
+    {
+      char c = m_data[m_pos];
+      if(isSpace(c) || (newlines && c=='\n'))
+        m_pos++;
+      else if(c=='\\' && continuation(m_pos))
+        m_pos = m_data.find('\n', m_pos)+1;
+      else
+        break;
+    }
+  }
+
+  //################################################################################################
+  //! Returns true if the backslash at i is only followed by spaces before the end of the line.
+  bool continuation(size_t i) const
+  {
+    for(i++; i<m_data.size(); i++)
+    {
+      if(m_data[i]=='\n')
+        return true;
+      if(!isSpace(m_data[i]))
+        return false;
+    }
+    return false;
+  }
+
+  //################################################################################################
+  void skipComment()
+  {
+    auto i = m_data.find('\n', m_pos);
+    m_pos = (i==std::string_view::npos)?m_data.size():i;
+  }
+
+  //################################################################################################
+  void skipLine()
+  {
+    while(m_pos<m_data.size() && m_data[m_pos]!='\n' && m_data[m_pos]!='}')
+    {
+      if(m_data[m_pos]=='\\' && continuation(m_pos))
+        m_pos = m_data.find('\n', m_pos);
+      m_pos++;
+    }
+  }
+
+  //################################################################################################
+  void statement()
+  {
+    size_t singleLineScopes=0;
+    size_t statementStart = m_pos;
+    size_t start = m_pos;
+    int depth=0;
+
+    auto popSingleLineScopes = [&]
+    {
+      if(singleLineScopes)
+      {
+        m_scopes.resize(m_scopes.size()-singleLineScopes);
+        updateScope();
+      }
+    };
+
+    while(m_pos<m_data.size())
+    {
+      char c = m_data[m_pos];
+
+      if(c=='(')
+        depth++;
+      else if(c==')')
+        depth--;
+      else if(depth>0)
+      {
+        if(c=='\n')
+          break;
+      }
+      else if(c=='{')
+      {
+        // Block scope, any single line scopes before it are part of its condition.
+        m_scopes.resize(m_scopes.size()-singleLineScopes);
+        m_scopes.push_back(trim(m_data.substr(statementStart, m_pos-statementStart)));
+        m_pos++;
+        updateScope();
+        return;
+      }
+      else if(c==':')
+      {
+        m_scopes.push_back(trim(m_data.substr(start, m_pos-start)));
+        singleLineScopes++;
+        m_pos++;
+        start = m_pos;
+        updateScope();
+        continue;
+      }
+      else if(c=='=')
+      {
+        size_t end = m_pos;
+        PRIOperator op = PRIOperator::Assign;
+        if(end>start)
+        {
+          switch(m_data[end-1])
+          {
+          case '+': op = PRIOperator::Append;       end--; break;
+          case '-': op = PRIOperator::Remove;       end--; break;
+          case '*': op = PRIOperator::AppendUnique; end--; break;
+          case '~': op = PRIOperator::Replace;      end--; break;
+          default: break;
+          }
+        }
+
+        auto variable = trim(m_data.substr(start, end-start));
+        m_pos++;
+
+        bool valid = !variable.empty();
+        for(auto v : variable)
+          valid = valid && isVariableChar(v);
+
+        if(valid)
+        {
+          m_statement.variable = variable;
+          m_statement.op = op;
+          values();
+          m_closure(m_statement);
+        }
+        else
+          skipLine();
+
+        popSingleLineScopes();
+        return;
+      }
+      else if(c=='\n' || c=='#' || c=='}')
+        break;
+      else if(c=='\\' && continuation(m_pos))
+      {
+        m_pos = m_data.find('\n', m_pos)+1;
+        continue;
+      }
+
+      m_pos++;
+    }
+
+    // Not an assignment, for example a function call like include(file.pri).
+    skipLine();
+    popSingleLineScopes();
+  }
+
+  //################################################################################################
+  void values()
+  {
+    m_statement.values.clear();
+
+    for(;;)
+    {
+      skipSpace(false);
+      if(m_pos>=m_data.size())
+        return;
+
+      char c = m_data[m_pos];
+      if(c=='\n' || c=='}')
+        return;
+
+      if(c=='#')
+      {
+        skipComment();
+        return;
+      }
+
+      if(c=='"')
+      {
+        size_t start = ++m_pos;
+        while(m_pos<m_data.size() && m_data[m_pos]!='"' && m_data[m_pos]!='\n')
+          m_pos++;
+        m_statement.values.push_back(m_data.substr(start, m_pos-start));
+        if(m_pos<m_data.size() && m_data[m_pos]=='"')
+          m_pos++;
+        continue;
+      }
+
+      size_t start = m_pos;
+      int braces=0;
+      int parens=0;
+      while(m_pos<m_data.size())
+      {
+        c = m_data[m_pos];
+        if(c=='{')
+          braces++;
+        else if(c=='(')
+          parens++;
+        else if(c==')' && parens>0)
+          parens--;
+        else if(c=='}')
+        {
+          if(braces==0)
+            break;
+          braces--;
+        }
+        else if(parens==0 && (isSpace(c) || c=='\n' || c=='#'))
+          break;
+        else if(c=='\\' && continuation(m_pos))
+          break;
+
+        m_pos++;
+      }
+      m_statement.values.push_back(m_data.substr(start, m_pos-start));
+    }
+  }
+
+  //################################################################################################
+  void updateScope()
+  {
+    m_scope.clear();
+    for(const auto& scope : m_scopes)
+    {
+      if(!m_scope.empty())
+        m_scope += ':';
+      m_scope.append(scope.data(), scope.size());
+    }
+    m_statement.scope = m_scope;
+  }
+
+  std::string_view m_data;
+  const std::function<void(const PRIStatement&)>& m_closure;
+  size_t m_pos{0};
+
+  std::vector<std::string_view> m_scopes;
+  std::string m_scope;
+  PRIStatement m_statement;
+};
+
+}
+
+//##################################################################################################
+void parsePRI(std::string_view data, const std::function<void(const PRIStatement&)>& closure)
+{
+  Tokenizer(data, closure).run();
+}
+
+//##################################################################################################
+std::string expandPRIValue(std::string_view value, const PRIVariables& variables)
+{
+  if(value.find("$$") == std::string_view::npos)
+    return std::string(value);
+
+  std::string result;
+  result.reserve(value.size());
+
+  for(size_t i=0; i<value.size();)
+  {
+    if(value.compare(i, 2, "$$") != 0)
+    {
+      result += value[i++];
+      continue;
+    }
+
+    i+=2;
+    if(i<value.size() && value[i]=='(')
+    {
+      auto end = value.find(')', i);
+      if(end == std::string_view::npos)
+        break;
+      if(const char* env = std::getenv(std::string(value.substr(i+1, end-i-1)).c_str()); env)
+        result += env;
+      i = end+1;
+      continue;
+    }
+
+    std::string_view name;
+    if(i<value.size() && value[i]=='{')
+    {
+      auto end = value.find('}', i);
+      if(end == std::string_view::npos)
+        break;
+      name = value.substr(i+1, end-i-1);
+      i = end+1;
+    }
+    else
+    {
+      size_t start=i;
+      while(i<value.size() && isVariableChar(value[i]))
+        i++;
+      name = value.substr(start, i-start);
+    }
+
+    if(auto v=variables.find(std::string(name)); v!=variables.end())
+    {
+      for(size_t n=0; n<v->second.size(); n++)
+      {
+        if(n)
+          result += ' ';
+        result += v->second.at(n);
+      }
+    }
+  }
+
+  return result;
+}
+
+//##################################################################################################
+PRIVariables evaluatePRIFile(const std::string& path)
+{
+  std::string data = tp_utils::readTextFile(path);
+
+  PRIVariables variables;
+  std::vector<std::string> expanded;
+  parsePRI(data, [&](const PRIStatement& statement)
+  {
+    expanded.clear();
+    for(const auto& value : statement.values)
+      expandValues(value, variables, expanded);
+
+    auto& values = variables[std::string(statement.variable)];
+    bool scoped = !statement.scope.empty();
+
+    switch(statement.op)
+    {
+    case PRIOperator::Assign:
+      if(!scoped)
+        values.clear();
+      [[fallthrough]];
+    case PRIOperator::Append:
+      values.insert(values.end(), expanded.begin(), expanded.end());
+      break;
+
+    case PRIOperator::AppendUnique:
+      for(const auto& v : expanded)
+        if(!tpContains(values, v))
+          values.push_back(v);
+      break;
+
+    case PRIOperator::Remove:
+      if(!scoped)
+        for(const auto& v : expanded)
+          values.erase(std::remove(values.begin(), values.end(), v), values.end());
+      break;
+
+    case PRIOperator::Replace:
+      break;
+    }
+  });
+
+  return variables;
+}
+
+}
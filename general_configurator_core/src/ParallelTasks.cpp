@@ -0,0 +1,111 @@
+#include "general_configurator_core/ParallelTasks.h"
+
+#include "tp_utils/Progress.h"
+
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+void ProgressMessages::addMessage(const std::string& message)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_messages.emplace_back(false, message);
+}
+
+//##################################################################################################
+void ProgressMessages::addError(const std::string& error)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_messages.emplace_back(true, error);
+}
+
+//##################################################################################################
+void ProgressMessages::forward(tp_utils::Progress* progress)
+{
+  std::vector<std::pair<bool, std::string>> messages;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    messages.swap(m_messages);
+  }
+
+  for(const auto& [isError, message] : messages)
+  {
+    if(isError)
+      progress->addError(message);
+    else
+      progress->addMessage(message);
+  }
+}
+
+//##################################################################################################
+bool runParallel(size_t count,
+                 size_t maxThreads,
+                 bool stopOnFailure,
+                 const std::function<bool(size_t)>& task,
+                 const std::function<bool()>& idle)
+{
+  if(maxThreads == 0)
+    maxThreads = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::atomic<bool> stop{false};
+
+  std::mutex mutex;
+  std::condition_variable finishedCondition;
+  size_t finishedThreads{0};
+
+  auto worker = [&]
+  {
+    while(!stop)
+    {
+      size_t i = next++;
+      if(i>=count)
+        break;
+
+      if(!task(i))
+      {
+        failed = true;
+        if(stopOnFailure)
+          stop = true;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finishedThreads++;
+    finishedCondition.notify_all();
+  };
+
+  size_t threadCount = std::min(maxThreads, count);
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount);
+  for(size_t t=0; t<threadCount; t++)
+    threads.emplace_back(worker);
+
+  for(;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if(finishedCondition.wait_for(lock, std::chrono::milliseconds(50), [&]{return finishedThreads==threadCount;}))
+        break;
+    }
+
+    if(idle && !idle())
+      stop = true;
+  }
+
+  for(auto& thread : threads)
+    thread.join();
+
+  if(idle)
+    idle();
+
+  return !failed && next>=count;
+}
+
+}
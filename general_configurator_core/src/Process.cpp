@@ -0,0 +1,440 @@
+#include "general_configurator_core/Process.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace general_configurator
+{
+
+namespace
+{
+
+#ifdef _WIN32
+
+//##################################################################################################
+std::string quoteArgument(const std::string& argument)
+{
+  if(!argument.empty() && argument.find_first_of(" \t\"&|<>^") == std::string::npos)
+    return argument;
+
+  std::string quoted = "\"";
+  for(char c : argument)
+  {
+    if(c=='"')
+      quoted += '\\';
+    quoted += c;
+  }
+  quoted += '"';
+  return quoted;
+}
+
+#else
+
+//##################################################################################################
+struct RunningProcess
+{
+  size_t task{0};
+  pid_t pid{-1};
+  int fds[2]{-1, -1};        //!< The read ends of the stdout and stderr pipes.
+  std::string partial[2];    //!< Output that does not end in a new line yet.
+  std::chrono::steady_clock::time_point start;
+  int64_t timeoutMS{0};
+  bool exited{false};
+  int status{0};
+  ProcessResult result;
+};
+
+//##################################################################################################
+void closeFD(int& fd)
+{
+  if(fd != -1)
+  {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+//##################################################################################################
+bool makePipe(int fds[2])
+{
+  // Neither end should leak into other children, the child gets its end through dup2 which clears
+  // the flag on the copy. Processes are started from several threads so the flag has to be set
+  // when the pipe is created, macOS has no pipe2 so there spawn uses POSIX_SPAWN_CLOEXEC_DEFAULT.
+#ifdef __APPLE__
+  if(::pipe(fds) != 0)
+    return false;
+
+  for(int i=0; i<2; i++)
+    ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+#else
+  if(::pipe2(fds, O_CLOEXEC) != 0)
+    return false;
+#endif
+
+  ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+//##################################################################################################
+//! Kill the process group of a child, git and tpUpdate start processes of their own.
+void killProcess(pid_t pid)
+{
+  if(::kill(-pid, SIGKILL) != 0)
+    ::kill(pid, SIGKILL);
+}
+
+//##################################################################################################
+//! Start a process, returns an empty string on success or a description of the failure.
+std::string spawn(const ProcessParams& params, RunningProcess& process)
+{
+  if(params.arguments.empty())
+    return "No program to run.";
+
+  int outPipe[2]{-1, -1};
+  int errPipe[2]{-1, -1};
+  if(!makePipe(outPipe) || !makePipe(errPipe))
+  {
+    closeFD(outPipe[0]);
+    closeFD(outPipe[1]);
+    return std::string("Failed to create pipe: ") + std::strerror(errno);
+  }
+
+  auto closePipes = [&]
+  {
+    for(int* fd : {&outPipe[0], &outPipe[1], &errPipe[0], &errPipe[1]})
+      closeFD(*fd);
+  };
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, outPipe[1], 1);
+  posix_spawn_file_actions_adddup2(&actions, errPipe[1], 2);
+  if(!params.workingDirectory.empty())
+  {
+    if(int ret = posix_spawn_file_actions_addchdir_np(&actions, params.workingDirectory.c_str()); ret != 0)
+    {
+      posix_spawn_file_actions_destroy(&actions);
+      closePipes();
+      return "Failed to set the working directory of " + params.arguments.front() + ": " + std::strerror(ret);
+    }
+  }
+
+  // Give the child default signal handling even if this process ignores SIGPIPE, and put it in a
+  // new process group so that it can be killed along with everything it started.
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t defaultSignals;
+  sigemptyset(&defaultSignals);
+  sigaddset(&defaultSignals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+  posix_spawnattr_setpgroup(&attributes, 0);
+  short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP;
+#ifdef __APPLE__
+  flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#endif
+  posix_spawnattr_setflags(&attributes, flags);
+
+  std::vector<char*> argv;
+  argv.reserve(params.arguments.size()+1);
+  for(const auto& argument : params.arguments)
+    argv.push_back(const_cast<char*>(argument.c_str()));
+  argv.push_back(nullptr);
+
+  int ret = posix_spawnp(&process.pid, argv.front(), &actions, &attributes, argv.data(), environ);
+
+  posix_spawnattr_destroy(&attributes);
+  posix_spawn_file_actions_destroy(&actions);
+  closeFD(outPipe[1]);
+  closeFD(errPipe[1]);
+
+  if(ret != 0)
+  {
+    closePipes();
+    return "Failed to start " + params.arguments.front() + ": " + std::strerror(ret);
+  }
+
+  process.fds[0] = outPipe[0];
+  process.fds[1] = errPipe[0];
+  process.start = std::chrono::steady_clock::now();
+  process.timeoutMS = params.timeoutMS;
+  return std::string();
+}
+
+#endif
+
+}
+
+//##################################################################################################
+bool ProcessResult::success() const
+{
+  return error.empty() && !timedOut && !cancelled && exitCode==0;
+}
+
+//##################################################################################################
+std::string ProcessResult::errorMessage() const
+{
+  if(!error.empty())
+    return error;
+
+  if(timedOut)
+    return "Timed out.";
+
+  if(cancelled)
+    return "Cancelled.";
+
+  return "Return code: " + std::to_string(exitCode);
+}
+
+//##################################################################################################
+ProcessResult runProcess(const ProcessParams& params, const ProcessObserver& observer)
+{
+  ProcessResult result;
+  bool started=false;
+
+  runProcesses(1, 1, [&](size_t, const ProcessResult* previous, ProcessParams& next)
+  {
+    started = true;
+    if(previous)
+    {
+      result = *previous;
+      return false;
+    }
+
+    next = params;
+    return true;
+  }, [&](size_t, const std::string& line, bool)
+  {
+    if(observer.output)
+      observer.output(line);
+  }, [&]
+  {
+    return observer.shouldStop && observer.shouldStop();
+  });
+
+  if(!started)
+    result.cancelled = true;
+
+  return result;
+}
+
+//##################################################################################################
+void runProcesses(size_t taskCount,
+                  size_t maxConcurrent,
+                  const std::function<bool(size_t, const ProcessResult*, ProcessParams&)>& nextProcess,
+                  const std::function<void(size_t, const std::string&, bool)>& output,
+                  const std::function<bool()>& shouldStop)
+{
+#ifdef _WIN32
+  (void)maxConcurrent;
+  (void)output;
+  for(size_t task=0; task<taskCount && !shouldStop(); task++)
+  {
+    ProcessParams params;
+    ProcessResult result;
+    for(const ProcessResult* previous=nullptr; nextProcess(task, previous, params); previous=&result)
+    {
+      result = ProcessResult();
+      if(shouldStop())
+      {
+        result.cancelled = true;
+        nextProcess(task, &result, params);
+        return;
+      }
+
+      std::string command;
+      if(!params.workingDirectory.empty())
+        command = "cd /d " + quoteArgument(params.workingDirectory) + " && ";
+      for(size_t a=0; a<params.arguments.size(); a++)
+        command += (a?" ":"") + quoteArgument(params.arguments.at(a));
+
+      // Keep the output of the child off stdout, the command line prints its results there.
+      command += " 1>&2";
+
+      result.exitCode = std::system(command.c_str());
+      params = ProcessParams();
+    }
+  }
+#else
+  if(maxConcurrent == 0)
+    maxConcurrent = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+
+  std::vector<RunningProcess> running;
+  size_t nextTask=0;
+  bool stopping=false;
+
+  // Ask a task for its next process and start it, failures to start are handed straight back.
+  auto advance = [&](size_t task, const ProcessResult* previous)
+  {
+    ProcessParams params;
+    ProcessResult failed;
+    while(nextProcess(task, previous, params))
+    {
+      RunningProcess process;
+      process.task = task;
+      failed = ProcessResult();
+      failed.error = spawn(params, process);
+      if(failed.error.empty())
+      {
+        running.push_back(std::move(process));
+        return;
+      }
+
+      previous = &failed;
+      params = ProcessParams();
+    }
+  };
+
+  auto emitLines = [&](RunningProcess& process, size_t stream, bool flush)
+  {
+    auto& partial = process.partial[stream];
+    size_t begin=0;
+    for(size_t end=partial.find('\n'); end!=std::string::npos; end=partial.find('\n', begin))
+    {
+      std::string line = partial.substr(begin, end-begin);
+      if(!line.empty() && line.back()=='\r')
+        line.pop_back();
+
+      process.result.output += line + '\n';
+      output(process.task, line, stream==1);
+      begin = end+1;
+    }
+    partial.erase(0, begin);
+
+    if(flush && !partial.empty())
+    {
+      process.result.output += partial + '\n';
+      output(process.task, partial, stream==1);
+      partial.clear();
+    }
+  };
+
+  // Read whatever is available without blocking, closes the pipe at the end of the stream.
+  auto drain = [&](RunningProcess& process, size_t stream)
+  {
+    char buffer[4096];
+    auto& fd = process.fds[stream];
+    while(fd != -1)
+    {
+      ssize_t n = ::read(fd, buffer, sizeof(buffer));
+      if(n>0)
+      {
+        process.partial[stream].append(buffer, size_t(n));
+        continue;
+      }
+
+      if(n<0 && errno==EINTR)
+        continue;
+
+      if(n==0 || (errno!=EAGAIN && errno!=EWOULDBLOCK))
+      {
+        closeFD(fd);
+        emitLines(process, stream, true);
+      }
+      break;
+    }
+    emitLines(process, stream, false);
+  };
+
+  for(;;)
+  {
+    if(!stopping && shouldStop())
+    {
+      stopping = true;
+      for(auto& process : running)
+      {
+        if(!process.result.timedOut)
+        {
+          process.result.cancelled = true;
+          killProcess(process.pid);
+        }
+      }
+    }
+
+    while(!stopping && running.size()<maxConcurrent && nextTask<taskCount)
+      advance(nextTask++, nullptr);
+
+    if(running.empty())
+      break;
+
+    std::vector<pollfd> fds;
+    for(const auto& process : running)
+      for(int fd : process.fds)
+        if(fd != -1)
+          fds.push_back({fd, POLLIN, 0});
+
+    ::poll(fds.data(), nfds_t(fds.size()), 50);
+
+    std::vector<RunningProcess> finished;
+    for(auto& process : running)
+    {
+      drain(process, 0);
+      drain(process, 1);
+
+      if(::waitpid(process.pid, &process.status, WNOHANG) == process.pid)
+      {
+        process.exited = true;
+        finished.push_back(std::move(process));
+        continue;
+      }
+
+      auto& result = process.result;
+      if(!result.timedOut && !result.cancelled && process.timeoutMS>0 &&
+         std::chrono::steady_clock::now()-process.start > std::chrono::milliseconds(process.timeoutMS))
+      {
+        result.timedOut = true;
+        killProcess(process.pid);
+      }
+    }
+
+    running.erase(std::remove_if(running.begin(), running.end(), [](const auto& process)
+    {
+      return process.exited;
+    }), running.end());
+
+    for(auto& process : finished)
+    {
+      // The output of the process is already in the pipes, anything that is still holding them
+      // open after this is a grandchild that we don't wait for.
+      drain(process, 0);
+      drain(process, 1);
+      closeFD(process.fds[0]);
+      closeFD(process.fds[1]);
+      emitLines(process, 0, true);
+      emitLines(process, 1, true);
+
+      auto& result = process.result;
+      if(WIFEXITED(process.status))
+        result.exitCode = WEXITSTATUS(process.status);
+      else if(WIFSIGNALED(process.status))
+        result.exitCode = 128 + WTERMSIG(process.status);
+
+      if(stopping)
+      {
+        ProcessParams ignored;
+        nextProcess(process.task, &result, ignored);
+      }
+      else
+        advance(process.task, &result);
+    }
+  }
+#endif
+}
+
+}
@@ -0,0 +1,371 @@
+#include "general_configurator_core/ReplaceNames.h"
+#include "general_configurator_core/FileCopy.h"
+#include "general_configurator_core/MappedFile.h"
+#include "general_configurator_core/ParallelTasks.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+//! Like git, treat files with a nul byte near the start as binary.
+bool isBinary(std::string_view data)
+{
+  return !data.empty() && std::memchr(data.data(), 0, std::min(data.size(), size_t(8000))) != nullptr;
+}
+
+//##################################################################################################
+bool writeFileAtomic(const std::string& path, const std::string& data, uint32_t mode, std::string& error)
+{
+  std::string tmpPath = path + ".replace_tmp";
+
+#ifdef _WIN32
+  (void)mode;
+  if(!tp_utils::writeBinaryFile(tmpPath, data))
+  {
+    error = "Failed to write: " + tmpPath;
+    return false;
+  }
+  std::remove(path.c_str());
+#else
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+  if(fd == -1)
+  {
+    error = "Failed to create: " + tmpPath + " (" + std::strerror(errno) + ")";
+    return false;
+  }
+
+  for(size_t written=0; written<data.size();)
+  {
+    ssize_t n = ::write(fd, data.data()+written, data.size()-written);
+    if(n<0)
+    {
+      if(errno==EINTR)
+        continue;
+
+      error = "Failed to write: " + tmpPath + " (" + std::strerror(errno) + ")";
+      ::close(fd);
+      ::unlink(tmpPath.c_str());
+      return false;
+    }
+    written += size_t(n);
+  }
+  ::close(fd);
+#endif
+
+  if(std::rename(tmpPath.c_str(), path.c_str()) != 0)
+  {
+    error = "Failed to replace: " + path;
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+
+//##################################################################################################
+struct FileResult
+{
+  bool scanned{false};
+  bool binary{false};
+  bool changed{false};
+  size_t bytes{0};
+  std::string error;
+};
+
+//##################################################################################################
+bool replaceFile(const std::string& path,
+                 const TreeEntry& entry,
+                 const std::vector<ReplaceRule>& rules,
+                 const MultiPatternMatcher& matcher,
+                 FileResult& result)
+{
+  std::string replaced;
+  {
+    MappedFile file(path);
+    if(file.size() != entry.size)
+    {
+      result.error = "Failed to read: " + path;
+      return false;
+    }
+
+    auto text = file.view();
+    if(isBinary(text))
+    {
+      result.binary = true;
+      return true;
+    }
+
+    result.scanned = true;
+    result.bytes = text.size();
+
+    size_t copied=0;
+    matcher.findAll(text, [&](size_t position, size_t pattern)
+    {
+      replaced.append(text.data()+copied, position-copied);
+      replaced += rules.at(pattern).to;
+      copied = position + matcher.patternLength(pattern);
+      result.changed = true;
+    });
+
+    if(!result.changed)
+      return true;
+
+    replaced.append(text.data()+copied, text.size()-copied);
+  }
+
+  return writeFileAtomic(path, replaced, entry.mode, result.error);
+}
+}
+
+//##################################################################################################
+MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string>& patterns)
+{
+  auto addNode = [&](uint32_t depth)
+  {
+    auto& next = m_next.emplace_back();
+    next.fill(0);
+    m_depth.push_back(depth);
+    m_terminal.push_back(npos);
+    m_longestMatch.push_back(npos);
+    return uint32_t(m_next.size()-1);
+  };
+
+  // Build the trie, 0 is the root so it also means "no edge" while building.
+  addNode(0);
+  for(size_t p=0; p<patterns.size(); p++)
+  {
+    const auto& pattern = patterns.at(p);
+    m_patternLengths.push_back(pattern.size());
+    if(pattern.empty())
+      continue;
+
+    uint32_t node=0;
+    for(char c : pattern)
+    {
+      if(!m_next[node][uint8_t(c)])
+      {
+        uint32_t child = addNode(m_depth[node]+1);
+        m_next[node][uint8_t(c)] = child;
+      }
+      node = m_next[node][uint8_t(c)];
+    }
+
+    if(m_terminal[node] == npos)
+      m_terminal[node] = p;
+  }
+
+  // Breadth first, replace missing edges with the edge of the fail node so that matching is a single
+  // table lookup per byte.
+  std::vector<uint32_t> fail(m_next.size(), 0);
+  std::vector<uint32_t> queue;
+  for(size_t c=0; c<256; c++)
+    if(uint32_t child = m_next[0][c]; child)
+      queue.push_back(child);
+
+  for(size_t i=0; i<queue.size(); i++)
+  {
+    uint32_t node = queue.at(i);
+    m_longestMatch[node] = (m_terminal[node]!=npos)?m_terminal[node]:m_longestMatch[fail[node]];
+
+    for(size_t c=0; c<256; c++)
+    {
+      uint32_t child = m_next[node][c];
+      if(child && m_depth[child] == m_depth[node]+1)
+      {
+        fail[child] = m_next[fail[node]][c];
+        queue.push_back(child);
+      }
+      else
+        m_next[node][c] = m_next[fail[node]][c];
+    }
+  }
+}
+
+//##################################################################################################
+void MultiPatternMatcher::findAll(std::string_view text, const std::function<void(size_t, size_t)>& found) const
+{
+  size_t pendingStart=npos;
+  size_t pendingPattern=npos;
+  uint32_t state=0;
+  size_t i=0;
+
+  // When a match is accepted scanning restarts from its end, matches can't overlap.
+  auto accept = [&]
+  {
+    found(pendingStart, pendingPattern);
+    i = pendingStart + m_patternLengths[pendingPattern];
+    state = 0;
+    pendingStart = npos;
+  };
+
+  for(;;)
+  {
+    if(i == text.size())
+    {
+      if(pendingStart == npos)
+        return;
+      accept();
+      continue;
+    }
+
+    state = m_next[state][uint8_t(text[i])];
+    i++;
+
+    // The longest pattern ending here is also the one that starts furthest left, a later match that
+    // starts in the same place is longer.
+    if(size_t p = m_longestMatch[state]; p != npos)
+    {
+      size_t start = i - m_patternLengths[p];
+      if(pendingStart == npos || start<=pendingStart)
+      {
+        pendingStart = start;
+        pendingPattern = p;
+      }
+    }
+
+    // Once no partial match can start at or before the pending match it is the leftmost longest.
+    if(pendingStart != npos && i - m_depth[state] > pendingStart)
+      accept();
+  }
+}
+
+//##################################################################################################
+size_t MultiPatternMatcher::longestPrefix(std::string_view text) const
+{
+  size_t longest=npos;
+  uint32_t state=0;
+  for(char c : text)
+  {
+    uint32_t next = m_next[state][uint8_t(c)];
+    if(m_depth[next] != m_depth[state]+1)
+      break;
+
+    state = next;
+    if(m_terminal[state] != npos)
+      longest = m_terminal[state];
+  }
+  return longest;
+}
+
+//##################################################################################################
+size_t MultiPatternMatcher::patternLength(size_t pattern) const
+{
+  return m_patternLengths.at(pattern);
+}
+
+//##################################################################################################
+bool replaceNames(const std::string& directory,
+                  const std::vector<ReplaceRule>& rules,
+                  std::string& error,
+                  ReplaceStats* stats,
+                  size_t maxThreads)
+{
+  ReplaceStats localStats;
+  ReplaceStats& s = stats?*stats:localStats;
+
+  auto elapsedMS = [](std::chrono::steady_clock::time_point start)
+  {
+    return int64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+  };
+
+  std::vector<std::string> patterns;
+  patterns.reserve(rules.size());
+  for(const auto& rule : rules)
+    patterns.push_back(rule.from);
+  MultiPatternMatcher matcher(patterns);
+
+  //-- List the tree -------------------------------------------------------------------------------
+  std::vector<TreeEntry> entries;
+  {
+    auto start = std::chrono::steady_clock::now();
+    if(!listTree(directory, {".git"}, entries, error))
+      return false;
+    s.listMS = elapsedMS(start);
+  }
+
+  //-- Replace the contents of the files -----------------------------------------------------------
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<const TreeEntry*> files;
+    for(const auto& entry : entries)
+      if(entry.type == TreeEntry::Type::File)
+        files.push_back(&entry);
+
+    // Each task only writes to its own result, they are combined in tree order afterwards so the
+    // stats and the reported error don't depend on the number of threads.
+    std::vector<FileResult> results(files.size());
+    runParallel(files.size(), maxThreads, true, [&](size_t i)
+    {
+      const auto& entry = *files.at(i);
+      return replaceFile(tp_utils::pathAppend(directory, entry.path), entry, rules, matcher, results.at(i));
+    }, []
+    {
+      return true;
+    });
+
+    for(const auto& result : results)
+    {
+      if(!result.error.empty())
+      {
+        error = result.error;
+        return false;
+      }
+
+      if(result.binary)
+        s.binaryFiles++;
+      else if(result.scanned)
+      {
+        s.filesScanned++;
+        s.bytesScanned += result.bytes;
+        if(result.changed)
+          s.filesChanged++;
+      }
+    }
+
+    s.replaceMS = elapsedMS(start);
+  }
+
+  //-- Rename files and directories, children first ------------------------------------------------
+  {
+    auto start = std::chrono::steady_clock::now();
+    for(auto i=entries.rbegin(); i!=entries.rend(); ++i)
+    {
+      auto name = tp_utils::filename(i->path);
+      size_t pattern = matcher.longestPrefix(name);
+      if(pattern == MultiPatternMatcher::npos)
+        continue;
+
+      std::string from = tp_utils::pathAppend(directory, i->path);
+      std::string to = tp_utils::pathAppend(tp_utils::directoryName(from), rules.at(pattern).to + name.substr(matcher.patternLength(pattern)));
+      if(std::rename(from.c_str(), to.c_str()) != 0)
+      {
+        error = "Failed to rename: " + from + " to: " + to;
+        return false;
+      }
+
+      s.pathsRenamed++;
+    }
+    s.renameMS = elapsedMS(start);
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,364 @@
+#include "general_configurator_core/UpdateCache.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/ParallelTasks.h"
+#include "general_configurator_core/FetchSubmodules.h"
+#include "general_configurator_core/GitUtils.h"
+#include "general_configurator_core/PRIParser.h"
+#include "general_configurator_core/Process.h"
+
+#include "tp_utils/Progress.h"
+#include "tp_utils/FileUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace general_configurator
+{
+
+namespace
+{
+
+//##################################################################################################
+FetchParams fetchParams(const UpdateCacheParams& params)
+{
+  FetchParams fetchParams;
+  fetchParams.maxParallelFetches = params.maxParallelClones;
+  fetchParams.continueOnError = params.continueOnError;
+  fetchParams.cloneMode = params.cloneMode;
+  return fetchParams;
+}
+
+//##################################################################################################
+Module readModule(const std::string& path, const std::string& moduleName, const std::string& gitHead)
+{
+  auto filePath = [&](const std::string& filename)
+  {
+    return tp_utils::pathAppend(path, filename);
+  };
+
+  Module module;
+  module.name = moduleName;
+  module.gitHead = gitHead;
+  module.cloneMode = repoCloneMode(path);
+
+  {
+    module.gitRepoURL = readGitRemoteURL(path);
+    module.gitRepoPrefix = module.gitRepoURL;
+
+    auto i = module.gitRepoPrefix.rfind(moduleName);
+    if(i<module.gitRepoPrefix.size())
+      module.gitRepoPrefix = module.gitRepoPrefix.substr(0, i);
+  }
+
+  {
+    auto variables = evaluatePRIFile(filePath("dependencies.pri"));
+    for(const auto& dependency : variables["DEPENDENCIES"])
+      module.dependencies.insert(dependency);
+  }
+
+  {
+    auto variables = evaluatePRIFile(filePath("vars.pri"));
+    if(const auto& values = variables["TEMPLATE"]; !values.empty())
+      module.type = values.back();
+  }
+
+  return module;
+}
+
+}
+
+//##################################################################################################
+bool updateCache(Cache& cache, tp_utils::Progress* progress, const UpdateCacheParams& params)
+{
+  std::vector<Module> modules;
+  if(!updateCacheModules(cache, progress, modules, params))
+    return false;
+
+  if(!cache.setModules(modules))
+  {
+    progress->addError("Failed to write the cache index: " + cache.indexPath());
+    return false;
+  }
+
+  return true;
+}
+
+//##################################################################################################
+bool updateCacheModules(const Cache& cache,
+                        tp_utils::Progress* progress,
+                        std::vector<Module>& modules,
+                        const UpdateCacheParams& params)
+{
+  modules.clear();
+
+  std::string reposDirectory = cache.reposDirectory();
+
+  // A full update is built in a staging directory that only replaces the existing repos once every
+  // step has succeeded, so a failed update leaves the previous cache intact.
+  std::string workDirectory = params.incremental?reposDirectory:tp_utils::pathAppend(cache.cacheDirectory(), "repos.new");
+
+  std::unordered_set<std::string> existingRepos;
+  {
+    auto p = progress->addChildStep(params.incremental?"Listing existing repos":"Preparing staging directory", 0.05f);
+    if(!params.incremental)
+      tp_utils::rm(workDirectory, TPRecursive::Yes);
+    tp_utils::mkdir(workDirectory, TPCreateFullPath::Yes);
+
+    for(const auto& path : tp_utils::listDirectories(workDirectory))
+      existingRepos.insert(tp_utils::filename(path));
+
+    p->setProgress(1.0f, "Done.");
+  }
+
+  std::unordered_set<std::string> sourceRepoNames;
+  {
+    auto p = progress->addChildStep("Fetching source repos", 0.3f);
+    p->addMessage("Fetching repos into: " + workDirectory);
+
+    std::vector<FetchRepo> repos;
+    for(const auto& sourceRepo : cache.sourceRepos())
+    {
+      auto& repo = repos.emplace_back();
+      repo.name = repoNameFromURL(sourceRepo);
+      repo.url = sourceRepo;
+      repo.exists = tpContains(existingRepos, repo.name);
+      sourceRepoNames.insert(repo.name);
+    }
+
+    if(!fetchRepos(workDirectory, repos, fetchParams(params), p))
+    {
+      p->addError("Failed to fetch the source repos.");
+      return false;
+    }
+  }
+
+  // Everything reachable through submodules.pri from the source repos is still referenced.
+  auto referencedRepos = [&]
+  {
+    std::unordered_set<std::string> referenced;
+    std::vector<std::string> queue;
+    for(const auto& name : sourceRepoNames)
+      if(referenced.insert(name).second)
+        queue.push_back(name);
+
+    for(size_t i=0; i<queue.size(); i++)
+    {
+      auto submodulesFile = tp_utils::pathAppend(tp_utils::pathAppend(workDirectory, queue.at(i)), "submodules.pri");
+      for(const auto& subdir : parseSubmodules(submodulesFile))
+        if(auto name=submoduleRepoName(subdir.toString()); referenced.insert(name).second)
+          queue.push_back(name);
+    }
+
+    return referenced;
+  };
+
+  if(params.incremental)
+  {
+    auto p = progress->addChildStep("Updating existing submodules", 0.5f);
+
+    // Repos that are no longer referenced are not updated, they are removed once the update has
+    // succeeded.
+    auto referenced = referencedRepos();
+    std::vector<FetchRepo> repos;
+    for(const auto& name : existingRepos)
+    {
+      if(tpContains(referenced, name) && !tpContains(sourceRepoNames, name))
+      {
+        auto& repo = repos.emplace_back();
+        repo.name = name;
+        repo.exists = true;
+      }
+    }
+
+    if(!fetchRepos(workDirectory, repos, fetchParams(params), p))
+    {
+      p->addError("Failed to update the existing submodules.");
+      return false;
+    }
+  }
+
+  if(params.useTpUpdate)
+  {
+    auto p = progress->addChildStep("Runing tpUpdate to fetch submodules", 0.8f);
+    ProcessObserver observer;
+    observer.output = [&](const std::string& line){p->addMessage(line);};
+    observer.shouldStop = [&]{return p->shouldStop() || (params.cancel && *params.cancel);};
+    if(auto result = runProcess({{"tpUpdate", "noupdate"}, workDirectory}, observer); !result.success())
+    {
+      p->addError("Failed to run tpUpdate!");
+      p->addError(result.errorMessage());
+      return false;
+    }
+
+    p->setProgress(1.0f, "Done.");
+  }
+  else
+  {
+    auto p = progress->addChildStep("Fetching submodules", 0.8f);
+    std::vector<std::string> rootModules(sourceRepoNames.begin(), sourceRepoNames.end());
+    std::sort(rootModules.begin(), rootModules.end());
+    if(!fetchSubmodules(workDirectory, rootModules, fetchParams(params), p))
+      return false;
+
+    p->setProgress(1.0f, "Done.");
+  }
+
+  // Updated submodules may reference repos again, so this is worked out after fetching them.
+  std::vector<std::string> unreferenced;
+  if(params.incremental)
+  {
+    auto referenced = referencedRepos();
+    for(const auto& path : tp_utils::listDirectories(workDirectory))
+      if(auto name=tp_utils::filename(path); !tpContains(referenced, name))
+        unreferenced.push_back(name);
+  }
+
+  {
+    auto p = progress->addChildStep("Reading dependencies", 0.95f);
+
+    auto paths = tp_utils::listDirectories(workDirectory);
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [&](const auto& path)
+    {
+      return tpContains(unreferenced, tp_utils::filename(path));
+    }), paths.end());
+    std::sort(paths.begin(), paths.end());
+
+    // Each task writes to its own slot so the result is in path order whatever the thread count.
+    modules.resize(paths.size());
+    std::atomic<size_t> done{0};
+    std::atomic<size_t> reused{0};
+
+    bool ok = runParallel(paths.size(), params.maxParallelReads, false, [&](size_t i)
+    {
+      const auto& path = paths.at(i);
+      auto moduleName = tp_utils::filename(path);
+      auto gitHead = readGitHead(path);
+
+      // Only parse repos that have moved since the last update.
+      const Module* existing = (params.incremental && !gitHead.empty())?cache.findModule(moduleName):nullptr;
+      if(existing && existing->gitHead == gitHead)
+      {
+        modules[i] = *existing;
+        reused++;
+      }
+      else
+        modules[i] = readModule(path, moduleName, gitHead);
+
+      done++;
+      return true;
+    }, [&]
+    {
+      p->setProgress(float(done)/float(std::max(size_t(1), paths.size())));
+      return !p->shouldStop();
+    });
+
+    if(!ok)
+    {
+      p->addError("Reading dependencies was cancelled.");
+      return false;
+    }
+
+    p->addMessage("Read " + std::to_string(paths.size()-reused) + " modules, " + std::to_string(reused) + " unchanged.");
+
+    if(std::vector<tp_utils::StringID> cycle; !cache.sortModules(modules, &cycle))
+    {
+      std::string names;
+      for(const auto& name : cycle)
+        names += ' ' + name.toString();
+      p->addError("Dependency cycle between:" + names);
+      return false;
+    }
+  }
+
+  if(params.incremental)
+  {
+    auto p = progress->addChildStep("Removing unreferenced repos", 1.0f);
+    for(const auto& name : unreferenced)
+    {
+      p->addMessage("Removing: " + name);
+      tp_utils::rm(tp_utils::pathAppend(workDirectory, name), TPRecursive::Yes);
+    }
+    p->setProgress(1.0f, "Done.");
+  }
+  else
+  {
+    auto p = progress->addChildStep("Replacing existing repos", 1.0f);
+
+    // Move the old repos aside rather than deleting them first, so there is always a cache to go
+    // back to if the swap fails.
+    std::string oldDirectory = tp_utils::pathAppend(cache.cacheDirectory(), "repos.old");
+    tp_utils::rm(oldDirectory, TPRecursive::Yes);
+    bool hadRepos = tp_utils::exists(reposDirectory);
+    if(hadRepos && std::rename(reposDirectory.c_str(), oldDirectory.c_str()) != 0)
+    {
+      p->addError("Failed to move " + reposDirectory + " to " + oldDirectory);
+      return false;
+    }
+
+    if(std::rename(workDirectory.c_str(), reposDirectory.c_str()) != 0)
+    {
+      p->addError("Failed to move " + workDirectory + " to " + reposDirectory);
+      if(hadRepos)
+        std::rename(oldDirectory.c_str(), reposDirectory.c_str());
+      return false;
+    }
+
+    tp_utils::rm(oldDirectory, TPRecursive::Yes);
+    p->setProgress(1.0f, "Done.");
+  }
+
+  return true;
+}
+
+//##################################################################################################
+void readCacheRepos(const std::string& reposDirectory,
+                    std::vector<std::string>& sourceRepos,
+                    std::vector<Module>& modules)
+{
+  sourceRepos.clear();
+  modules.clear();
+
+  auto paths = tp_utils::listDirectories(reposDirectory);
+  std::sort(paths.begin(), paths.end());
+
+  modules.resize(paths.size());
+  std::vector<std::unordered_set<tp_utils::StringID>> submodules(paths.size());
+  runParallel(paths.size(), 0, false, [&](size_t i)
+  {
+    const auto& path = paths.at(i);
+    modules[i] = readModule(path, tp_utils::filename(path), readGitHead(path));
+    submodules[i] = parseSubmodules(tp_utils::pathAppend(path, "submodules.pri"));
+    return true;
+  }, []{return true;});
+
+  std::unordered_set<std::string> referenced;
+  for(size_t i=0; i<paths.size(); i++)
+    for(const auto& subdir : submodules.at(i))
+      if(auto name=submoduleRepoName(subdir.toString()); name!=modules.at(i).name.toString())
+        referenced.insert(name);
+
+  for(const auto& module : modules)
+    if(!tpContains(referenced, module.name.toString()) && !module.gitRepoURL.empty())
+      sourceRepos.push_back(module.gitRepoURL);
+}
+
+//##################################################################################################
+std::unordered_set<tp_utils::StringID> parseSubmodules(const std::string& path)
+{
+  std::unordered_set<tp_utils::StringID> subdirs;
+
+  auto variables = evaluatePRIFile(path);
+  for(const auto& subdir : variables["SUBDIRS"])
+    subdirs.insert(subdir);
+
+  return subdirs;
+}
+
+//##################################################################################################
+std::string submoduleRepoName(const std::string& subdir)
+{
+  return subdir.substr(0, subdir.find_first_of("/\\"));
+}
+
+}
@@ -0,0 +1,60 @@
+TARGET = general_configurator_core
+TEMPLATE = lib
+CONFIG -= qt
+
+HEADERS += inc/general_configurator_core/Globals.h
+SOURCES += src/Globals.cpp
+
+HEADERS += inc/general_configurator_core/ParallelTasks.h
+SOURCES += src/ParallelTasks.cpp
+
+HEADERS += inc/general_configurator_core/BackgroundTask.h
+SOURCES += src/BackgroundTask.cpp
+
+HEADERS += inc/general_configurator_core/MappedFile.h
+SOURCES += src/MappedFile.cpp
+
+HEADERS += inc/general_configurator_core/Process.h
+SOURCES += src/Process.cpp
+
+HEADERS += inc/general_configurator_core/GitUtils.h
+SOURCES += src/GitUtils.cpp
+
+HEADERS += inc/general_configurator_core/FileCopy.h
+SOURCES += src/FileCopy.cpp
+
+HEADERS += inc/general_configurator_core/ReplaceNames.h
+SOURCES += src/ReplaceNames.cpp
+
+HEADERS += inc/general_configurator_core/PRIParser.h
+SOURCES += src/PRIParser.cpp
+
+HEADERS += inc/general_configurator_core/ModuleGraph.h
+SOURCES += src/ModuleGraph.cpp
+
+HEADERS += inc/general_configurator_core/ModuleSearchIndex.h
+SOURCES += src/ModuleSearchIndex.cpp
+
+HEADERS += inc/general_configurator_core/Cache.h
+SOURCES += src/Cache.cpp
+
+HEADERS += inc/general_configurator_core/LibrarySelection.h
+SOURCES += src/LibrarySelection.cpp
+
+HEADERS += inc/general_configurator_core/BinaryIndex.h
+SOURCES += src/BinaryIndex.cpp
+
+HEADERS += inc/general_configurator_core/FetchSubmodules.h
+SOURCES += src/FetchSubmodules.cpp
+
+HEADERS += inc/general_configurator_core/UpdateCache.h
+SOURCES += src/UpdateCache.cpp
+
+HEADERS += inc/general_configurator_core/Generate.h
+SOURCES += src/Generate.cpp
+
+HEADERS += inc/general_configurator_core/BatchGenerate.h
+SOURCES += src/BatchGenerate.cpp
+
+HEADERS += inc/general_configurator_core/CommandLine.h
+SOURCES += src/CommandLine.cpp
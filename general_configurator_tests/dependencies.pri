@@ -0,0 +1 @@
+DEPENDENCIES += general_configurator_core
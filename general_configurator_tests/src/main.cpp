@@ -0,0 +1,122 @@
+#include "general_configurator_core/ParallelTasks.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace general_configurator;
+
+namespace
+{
+
+int failures=0;
+
+//##################################################################################################
+void check(bool ok, const std::string& what)
+{
+  if(!ok)
+  {
+    failures++;
+    std::cerr << "FAILED: " << what << std::endl;
+  }
+}
+
+//##################################################################################################
+void sleepMS(int ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+//##################################################################################################
+//! Each task writes to its own slot, the result must not depend on the thread count.
+void testResultSlots()
+{
+  for(size_t maxThreads : {size_t(1), size_t(3), size_t(0)})
+  {
+    std::vector<size_t> results(1000, 0);
+    bool ok = runParallel(results.size(), maxThreads, false, [&](size_t i)
+    {
+      results[i] = i*i;
+      return true;
+    }, []{return true;});
+
+    check(ok, "runParallel succeeds when every task succeeds");
+
+    bool inOrder=true;
+    for(size_t i=0; i<results.size(); i++)
+      inOrder = inOrder && results.at(i)==i*i;
+    check(inOrder, "every task writes its own slot with " + std::to_string(maxThreads) + " threads");
+  }
+
+  bool called=false;
+  check(runParallel(0, 4, false, [&](size_t){called=true; return true;}, nullptr), "no tasks succeeds");
+  check(!called, "no tasks are run for a count of 0");
+}
+
+//##################################################################################################
+//! A failure stops new tasks when stopOnFailure is set, otherwise the others still run.
+void testStopOnFailure()
+{
+  for(bool stopOnFailure : {true, false})
+  {
+    std::atomic<size_t> started{0};
+    bool ok = runParallel(200, 2, stopOnFailure, [&](size_t i)
+    {
+      started++;
+      sleepMS(1);
+      return i!=5;
+    }, []{return true;});
+
+    check(!ok, "runParallel fails when a task fails");
+    if(stopOnFailure)
+      check(started<200, "no new tasks start after a failure");
+    else
+      check(started==200, "every task runs when stopOnFailure is not set");
+  }
+}
+
+//##################################################################################################
+//! Returning false from idle cancels the tasks that have not started, the running ones finish.
+void testCancel()
+{
+  std::atomic<size_t> started{0};
+  std::atomic<size_t> finished{0};
+  size_t idleCalls=0;
+
+  bool ok = runParallel(10000, 2, false, [&](size_t)
+  {
+    started++;
+    sleepMS(5);
+    finished++;
+    return true;
+  }, [&]
+  {
+    idleCalls++;
+    return false;
+  });
+
+  check(!ok, "runParallel fails when it is cancelled");
+  check(started<10000, "no new tasks start after a cancel");
+  check(started==finished, "running tasks finish after a cancel");
+  check(idleCalls>=2, "idle is called again once the tasks have finished");
+}
+
+}
+
+//##################################################################################################
+int main()
+{
+  testResultSlots();
+  testStopOnFailure();
+  testCancel();
+
+  if(failures)
+  {
+    std::cerr << failures << " checks failed." << std::endl;
+    return 1;
+  }
+
+  std::cout << "All checks passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,5 @@
+TARGET = general_configurator_tests
+TEMPLATE = app
+CONFIG -= qt
+
+SOURCES += src/main.cpp
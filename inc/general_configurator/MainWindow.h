@@ -1,7 +1,7 @@
 #ifndef general_configurator_MainWindow_h
 #define general_configurator_MainWindow_h
 
-#include "general_configurator/Globals.h"
+#include "general_configurator_core/Globals.h"
 
 #include <QWidget>
 
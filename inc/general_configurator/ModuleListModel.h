@@ -0,0 +1,73 @@
+#ifndef general_configurator_ModuleListModel_h
+#define general_configurator_ModuleListModel_h
+
+#include "general_configurator_core/ModuleSearchIndex.h"
+
+#include <QAbstractListModel>
+
+namespace general_configurator
+{
+class Cache;
+class LibrarySelection;
+
+//##################################################################################################
+//! A list of the modules in the cache of some types, rows map straight to ids in Cache::graph().
+/*!
+No per row objects are created, the data is read from the cache graph when the view asks for it. If
+a selection is set each row gets a check box bound to it, checking a row updates the selection and
+only the rows whose state changed are reported to the view.
+*/
+class ModuleListModel : public QAbstractListModel
+{
+  TP_DQ;
+public:
+  //################################################################################################
+  ModuleListModel(Cache* cache, const std::vector<ModuleType>& types, QObject* parent=nullptr);
+
+  //################################################################################################
+  ~ModuleListModel() override;
+
+  //################################################################################################
+  //! Show check boxes bound to selection, nullptr for a plain list.
+  void setSelection(LibrarySelection* selection);
+
+  //################################################################################################
+  //! Rebuild the rows, call this when the modules in the cache change.
+  void reset();
+
+  //################################################################################################
+  //! Only list the modules that match query, using the search index of the cache.
+  void setQuery(const ModuleQuery& query);
+
+  //################################################################################################
+  //! Call after the selection has been reset to refresh the state of every row.
+  void selectionReset();
+
+  //################################################################################################
+  //! Tell the view that the state of these modules changed, adjacent rows are grouped.
+  void modulesChanged(std::vector<uint32_t> ids);
+
+  //################################################################################################
+  //! Returns the module id of a row or ModuleGraph::invalidID.
+  uint32_t moduleID(const QModelIndex& index) const;
+
+  //################################################################################################
+  //! Returns the index of a module or an invalid index if it is not in the list.
+  QModelIndex moduleIndex(uint32_t id) const;
+
+  //################################################################################################
+  int rowCount(const QModelIndex& parent=QModelIndex()) const override;
+
+  //################################################################################################
+  QVariant data(const QModelIndex& index, int role) const override;
+
+  //################################################################################################
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+  //################################################################################################
+  bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+};
+
+}
+
+#endif
@@ -1,9 +1,13 @@
 #include "general_configurator/MainWindow.h"
-#include "general_configurator/UpdateCache.h"
-#include "general_configurator/Cache.h"
-#include "general_configurator/Generate.h"
+#include "general_configurator/ModuleListModel.h"
+#include "general_configurator_core/BackgroundTask.h"
+#include "general_configurator_core/UpdateCache.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/ModuleGraph.h"
+#include "general_configurator_core/Generate.h"
+#include "general_configurator_core/LibrarySelection.h"
+#include "general_configurator_core/ModuleSearchIndex.h"
 
-#include "tp_qt_widgets/BlockingOperationDialog.h"
 #include "tp_qt_widgets/FileDialogLineEdit.h"
 
 #include "tp_utils/RefCount.h"
@@ -13,13 +17,19 @@
 #include <QGroupBox>
 #include <QLabel>
 #include <QPlainTextEdit>
-#include <QListWidget>
-#include <QTableWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QLineEdit>
-#include <QApplication>
 #include <QFileDialog>
 #include <QSettings>
+#include <QMessageBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QProgressDialog>
+#include <QTimer>
+
+#include <algorithm>
+#include <memory>
 
 namespace general_configurator
 {
@@ -34,8 +44,17 @@ struct MainWindow::Private
   Cache* cache;
 
   QPlainTextEdit* sourceRepos{nullptr};
-  QListWidget* appTemplates{nullptr};
-  QListWidget* libraries{nullptr};
+  QCheckBox* incrementalUpdate{nullptr};
+  QCheckBox* metadataClones{nullptr};
+  QCheckBox* useTpUpdate{nullptr};
+  QListView* appTemplates{nullptr};
+  QListView* libraries{nullptr};
+  QLineEdit* librarySearch{nullptr};
+  QComboBox* libraryPrefix{nullptr};
+  QComboBox* libraryType{nullptr};
+  ModuleListModel* appTemplatesModel{nullptr};
+  ModuleListModel* librariesModel{nullptr};
+  const std::vector<ModuleType> libraryTypes{ModuleType::Lib, ModuleType::Subdirs};
 
   tp_qt_widgets::FileDialogLineEdit* rootPath{nullptr};
   QLineEdit* appPath{nullptr};
@@ -46,6 +65,11 @@ struct MainWindow::Private
 
   Module appTemplateModule;
 
+  LibrarySelection selection;
+
+  //! The operation running on a worker thread, the cache must not be changed while this is set.
+  std::unique_ptr<BackgroundTask> task;
+
   //################################################################################################
   Private(Q* q_, Cache* cache_):
     q(q_),
@@ -54,25 +78,150 @@ struct MainWindow::Private
     cacheChanged.connect(cache->changed);
   }
 
+  //################################################################################################
+  //! Run closure on a worker thread while showing a modal progress dialog.
+  /*!
+  The dialog is updated from a timer so the event loop keeps running, finished is called on the GUI
+  thread once the closure has returned and is where results should be committed.
+  */
+  void runTask(const QString& title,
+               const std::function<bool(tp_utils::Progress*, const std::atomic<bool>&)>& closure,
+               const std::function<void(bool)>& finished)
+  {
+    auto dialog = new QProgressDialog(title, "Cancel", 0, 1000, q);
+    dialog->setWindowTitle(title);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(0);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+
+    // Keep the dialog open until the worker has actually stopped.
+    QObject::disconnect(dialog, &QProgressDialog::canceled, dialog, &QProgressDialog::cancel);
+    QObject::connect(dialog, &QProgressDialog::canceled, dialog, [this, dialog]
+    {
+      task->cancel();
+      dialog->setLabelText("Cancelling...");
+    });
+
+    task = std::make_unique<BackgroundTask>(title.toStdString(), closure);
+
+    auto timer = new QTimer(dialog);
+    QObject::connect(timer, &QTimer::timeout, dialog, [this, dialog, timer, title, finished]
+    {
+      auto state = task->state();
+      if(!state.finished)
+      {
+        dialog->setValue(int(state.progress*1000.0f));
+        if(!state.cancelled)
+          dialog->setLabelText(QString::fromStdString(state.description));
+        return;
+      }
+
+      timer->stop();
+      task.reset();
+      dialog->deleteLater();
+
+      if(!state.success && !state.cancelled)
+        QMessageBox::warning(q, title, state.error.empty()?"Failed.":QString::fromStdString(state.error));
+
+      finished(state.success);
+    });
+    timer->start(50);
+
+    dialog->show();
+  }
+
+  //################################################################################################
+  void indexWriteFailed()
+  {
+    QMessageBox::warning(q, "Cache", "Failed to write the cache index: " + QString::fromStdString(cache->indexPath()));
+  }
+
   //################################################################################################
   void updateCacheClicked()
   {
+    if(task)
+      return;
+
     std::vector<std::string> s;
     tpSplit(s, sourceRepos->toPlainText().toStdString(), '\n', TPSplitBehavior::SkipEmptyParts);
-    cache->setSourceRepos(s);
+    if(!cache->setSourceRepos(s))
+      indexWriteFailed();
 
-    tp_qt_widgets::BlockingOperationDialog::exec(poll, "Updating the cache", q, [&](tp_utils::Progress* progress)
+    QSettings().setValue("incrementalUpdate", incrementalUpdate->isChecked());
+    QSettings().setValue("metadataClones", metadataClones->isChecked());
+    QSettings().setValue("useTpUpdate", useTpUpdate->isChecked());
+
+    UpdateCacheParams params;
+    params.incremental = incrementalUpdate->isChecked();
+    params.cloneMode = metadataClones->isChecked()?CloneMode::Metadata:CloneMode::Full;
+    params.useTpUpdate = useTpUpdate->isChecked();
+
+    // The modules are only handed to the cache back on the GUI thread.
+    auto modules = std::make_shared<std::vector<Module>>();
+    runTask("Updating the cache", [cache=cache, params, modules](tp_utils::Progress* progress, const std::atomic<bool>& cancel)
     {
-      return updateCache(*cache, progress);
+      auto taskParams = params;
+      taskParams.cancel = &cancel;
+      return updateCacheModules(*cache, progress, *modules, taskParams);
+    }, [this, modules](bool success)
+    {
+      if(success && !cache->setModules(*modules))
+        indexWriteFailed();
     });
   }
 
+  //################################################################################################
+  void generateClicked()
+  {
+    if(task)
+      return;
+
+    auto templateName = appTemplateName();
+    auto rootPath = this->rootPath->text().toStdString();
+    auto modulePrefix = this->modulePrefix->text().toStdString();
+    auto moduleSuffix = this->moduleSuffix->text().toStdString();
+    auto selectedLibraries = selection.selectedLibraries();
+    auto allDependencies = selection.allDependencies();
+
+    QSettings().setValue("useTpUpdate", useTpUpdate->isChecked());
+    GenerateParams generateParams;
+    generateParams.useTpUpdate = useTpUpdate->isChecked();
+
+    runTask("Generating the app", [=, cache=cache](tp_utils::Progress* progress, const std::atomic<bool>& cancel)
+    {
+      auto params = generateParams;
+      params.cancel = &cancel;
+      return generateApp(*cache,
+                         templateName,
+                         rootPath,
+                         modulePrefix,
+                         moduleSuffix,
+                         selectedLibraries,
+                         allDependencies,
+                         progress,
+                         params);
+    }, [](bool){});
+  }
+
   //################################################################################################
   void sortCacheClicked()
   {
+    if(task)
+      return;
+
     auto modules = cache->modules();
-    cache->sortModules(modules);
-    cache->setModules(modules);
+    if(std::vector<tp_utils::StringID> cycle; !cache->sortModules(modules, &cycle))
+    {
+      QString names;
+      for(const auto& name : cycle)
+        names += '\n' + QString::fromStdString(name.toString());
+      QMessageBox::warning(q, "Sort cache", "Failed to sort the cache, dependency cycle between:" + names);
+      return;
+    }
+
+    if(!cache->setModules(modules))
+      indexWriteFailed();
   }
 
   //################################################################################################
@@ -95,21 +244,6 @@ struct MainWindow::Private
     tp_utils::writeTextFile(path, submodules);
   }
 
-  //################################################################################################
-  void resetLibraries()
-  {
-    libraries->clear();
-    for(const auto& module : cache->modules())
-    {
-      if(module.type == "lib" || module.type == "subdirs" )
-      {
-        auto item = new QListWidgetItem(QString::fromStdString(module.name.toString()));
-        item->setCheckState(Qt::Unchecked);
-        libraries->addItem(item);
-      }
-    }
-  }
-
   //################################################################################################
   void populateUI()
   {
@@ -121,43 +255,66 @@ struct MainWindow::Private
       sourceRepos->setPlainText(s);
     }
 
-    {
-      appTemplates->clear();
-      for(const auto& module : cache->modules())
-      {
-        if(module.type == "app")
-        {
-          auto item = new QListWidgetItem(QString::fromStdString(module.name.toString()));
-          appTemplates->addItem(item);
-        }
-      }
-
-      if(appTemplates->count()>0)
-        appTemplates->item(0)->setSelected(true);
-    }
+    updatePrefixFacet();
+    updateTypeFacet();
+    filterLibraries();
+    appTemplatesModel->reset();
+    // Selecting a row fires selectedAppTemplateChanged, with no rows clear the template instead.
+    if(appTemplatesModel->rowCount()>0)
+      appTemplates->setCurrentIndex(appTemplatesModel->index(0));
+    else
+      selectedAppTemplateChanged();
 
-    selectedAppTemplateChanged();
     updatePaths();
   }
 
   //################################################################################################
-  tp_utils::Callback<void()> cacheChanged = [&]()
+  //! Fill the prefix filter from the cache, keeping the current prefix if it is still there.
+  void updatePrefixFacet()
   {
-    populateUI();
-  };
+    QString current = libraryPrefix->currentData().toString();
+
+    QSignalBlocker blocker(libraryPrefix);
+    libraryPrefix->clear();
+    libraryPrefix->addItem("All prefixes", QString());
+    for(const auto& prefix : cache->searchIndex().prefixes())
+      libraryPrefix->addItem(QString::fromStdString(prefix), QString::fromStdString(prefix));
+
+    libraryPrefix->setCurrentIndex(std::max(0, libraryPrefix->findData(current)));
+  }
 
   //################################################################################################
-  bool inPoll=false;
-  std::function<bool()> poll = [&]
+  //! Fill the type filter with the library types in the cache, keeping the current type if it is still there.
+  void updateTypeFacet()
   {
-    if(inPoll)
-      return true;
+    QVariant current = libraryType->currentData();
 
-    inPoll=true;
-    QApplication::processEvents();
-    inPoll=false;
+    QSignalBlocker blocker(libraryType);
+    libraryType->clear();
+    libraryType->addItem("All types");
+    for(auto type : cache->searchIndex().types())
+      if(tpContains(libraryTypes, type))
+        libraryType->addItem(QString::fromStdString(moduleTypeToString(type)), int(type));
 
-    return true;
+    libraryType->setCurrentIndex(current.isValid()?std::max(0, libraryType->findData(current)):0);
+  }
+
+  //################################################################################################
+  void filterLibraries()
+  {
+    ModuleQuery query;
+    query.text = librarySearch->text().toStdString();
+    query.prefix = libraryPrefix->currentData().toString().toStdString();
+    if(auto type = libraryType->currentData(); type.isValid())
+      query.types.push_back(ModuleType(type.toInt()));
+
+    librariesModel->setQuery(query);
+  }
+
+  //################################################################################################
+  tp_utils::Callback<void()> cacheChanged = [&]()
+  {
+    populateUI();
   };
 
   //################################################################################################
@@ -184,125 +341,21 @@ struct MainWindow::Private
   //################################################################################################
   tp_utils::StringID appTemplateName()
   {
-    if(auto i = appTemplates->selectedItems(); !i.empty())
-      return i.front()->text().toStdString();
+    if(auto i = appTemplates->selectionModel()->selectedIndexes(); !i.empty())
+      if(auto id = appTemplatesModel->moduleID(i.front()); id != ModuleGraph::invalidID)
+        return cache->graph().name(id);
     return tp_utils::StringID();
   }
 
   //################################################################################################
   void selectedAppTemplateChanged()
   {
-    resetLibraries();
-
     appTemplateModule = cache->module(appTemplateName());
-
-    for(const auto& dependency : appTemplateModule.dependencies)
-      checkLibrary(dependency, false, true);
+    selection.reset(*cache, appTemplateModule.name);
+    librariesModel->selectionReset();
 
     updatePaths();
   }
-
-  //################################################################################################
-  void checkLibrary(const tp_utils::StringID& name, bool partial, bool required)
-  {
-    auto module = cache->module(name);
-
-    for(const auto& dependency : module.dependencies)
-      checkLibrary(dependency, true, required);
-
-    for(int row=0; row<libraries->count(); row++)
-    {
-      auto item = libraries->item(row);
-
-      if(name == item->text().toStdString())
-      {
-        if(partial && item->checkState() == Qt::Unchecked)
-          item->setCheckState(Qt::PartiallyChecked);
-        else if(!partial)
-          item->setCheckState(Qt::Checked);
-
-        if(required)
-        {
-          item->setFlags(item->flags() & (~Qt::ItemIsUserCheckable));
-          QFont fnt = item->font();
-          fnt.setWeight(QFont::Bold);
-          item->setFont(fnt);
-        }
-
-        break;
-      }
-    }
-  }
-  //################################################################################################
-  void uncheckLibrary(const tp_utils::StringID& name)
-  {
-    for(int row=0; row<libraries->count(); row++)
-    {
-      auto item = libraries->item(row);
-
-      if(name == item->text().toStdString())
-      {
-        item->setCheckState(Qt::Unchecked);
-        break;
-      }
-    }
-
-    for(const auto& module : cache->modules())
-      if(tpContains(module.dependencies, name))
-        uncheckLibrary(module.name);
-
-    for(int row=0; row<libraries->count(); row++)
-    {
-      auto item = libraries->item(row);
-      tp_utils::StringID n = item->text().toStdString();
-      if(item->checkState() == Qt::PartiallyChecked && !tpContains(allDependencies(), n))
-        uncheckLibrary(n);
-    }
-  }
-
-  //################################################################################################
-  void itemClicked(QListWidgetItem* item)
-  {
-    if((item->flags() & Qt::ItemIsUserCheckable) != Qt::ItemIsUserCheckable)
-      return;
-
-    tp_utils::StringID name = item->text().toStdString();
-
-    if(item->checkState() == Qt::Checked)
-      checkLibrary(name, false, false);
-
-    else if(item->checkState() == Qt::Unchecked)
-      uncheckLibrary(name);
-  }
-
-  //################################################################################################
-  std::unordered_set<tp_utils::StringID> selectedLibraries()
-  {
-    std::unordered_set<tp_utils::StringID> names;
-    for(int row=0; row<libraries->count(); row++)
-      if(auto item = libraries->item(row); item->checkState() == Qt::Checked)
-        names.insert(item->text().toStdString());
-    return names;
-  }
-
-  //################################################################################################
-  std::unordered_set<tp_utils::StringID> allDependencies()
-  {
-    std::unordered_set<tp_utils::StringID> names;
-    for(int row=0; row<libraries->count(); row++)
-    {
-      auto item = libraries->item(row);
-      tp_utils::StringID name = item->text().toStdString();
-
-      if(((item->flags() & Qt::ItemIsUserCheckable) != Qt::ItemIsUserCheckable) || item->checkState() == Qt::Checked)
-        names.insert(name);
-
-      if(item->checkState() != Qt::Unchecked)
-        for(const auto& dependency : cache->module(name).dependencies)
-          names.insert(dependency);
-    }
-    return names;
-  }
 };
 
 //##################################################################################################
@@ -333,6 +386,21 @@ MainWindow::MainWindow(Cache* cache):
     d->sourceRepos = new QPlainTextEdit();
     l->addWidget(d->sourceRepos);
 
+    d->incrementalUpdate = new QCheckBox("Incremental update");
+    d->incrementalUpdate->setToolTip("Fetch the repos that are already in the cache instead of cloning everything again.");
+    d->incrementalUpdate->setChecked(QSettings().value("incrementalUpdate", false).toBool());
+    l->addWidget(d->incrementalUpdate);
+
+    d->metadataClones = new QCheckBox("Metadata only clones");
+    d->metadataClones->setToolTip("Make shallow clones of new repos that only check out the .pri files.");
+    d->metadataClones->setChecked(QSettings().value("metadataClones", false).toBool());
+    l->addWidget(d->metadataClones);
+
+    d->useTpUpdate = new QCheckBox("Fetch submodules with tpUpdate");
+    d->useTpUpdate->setToolTip("Run the external tpUpdate script to fetch submodules, when updating the cache and generating apps.");
+    d->useTpUpdate->setChecked(QSettings().value("useTpUpdate", false).toBool());
+    l->addWidget(d->useTpUpdate);
+
     {
       auto button = new QPushButton("Update cache");
       l->addWidget(button);
@@ -360,11 +428,14 @@ MainWindow::MainWindow(Cache* cache):
 
     t(l, "<b>1. App template</b><br>"
          "Select the template that you would like to create your new program from.");
-    d->appTemplates = new QListWidget();
+    d->appTemplatesModel = new ModuleListModel(d->cache, {ModuleType::App}, this);
+    d->appTemplates = new QListView();
+    d->appTemplates->setUniformItemSizes(true);
     d->appTemplates->setSelectionMode(QAbstractItemView::SelectionMode::SingleSelection);
+    d->appTemplates->setModel(d->appTemplatesModel);
     l->addWidget(d->appTemplates);
 
-    connect(d->appTemplates, &QListWidget::itemSelectionChanged, this, [&]{d->selectedAppTemplateChanged();});
+    connect(d->appTemplates->selectionModel(), &QItemSelectionModel::selectionChanged, this, [&]{d->selectedAppTemplateChanged();});
   }
 
   {
@@ -375,10 +446,33 @@ MainWindow::MainWindow(Cache* cache):
 
     t(l, "<b>2. Libraries</b><br>"
          "Select the libraries that you want to use in your program.");
-    d->libraries = new QListWidget();
-    l->addWidget(d->libraries);
+    {
+      auto ll = new QHBoxLayout();
+      l->addLayout(ll);
+
+      d->librarySearch = new QLineEdit();
+      d->librarySearch->setPlaceholderText("Search");
+      d->librarySearch->setClearButtonEnabled(true);
+      connect(d->librarySearch, &QLineEdit::textChanged, this, [&]{d->filterLibraries();});
+      ll->addWidget(d->librarySearch);
+
+      d->libraryPrefix = new QComboBox();
+      d->libraryPrefix->addItem("All prefixes", QString());
+      connect(d->libraryPrefix, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [&]{d->filterLibraries();});
+      ll->addWidget(d->libraryPrefix);
+
+      d->libraryType = new QComboBox();
+      d->libraryType->addItem("All types");
+      connect(d->libraryType, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [&]{d->filterLibraries();});
+      ll->addWidget(d->libraryType);
+    }
 
-    connect(d->libraries, &QListWidget::itemClicked, this, [&](QListWidgetItem* item){d->itemClicked(item);});
+    d->librariesModel = new ModuleListModel(d->cache, d->libraryTypes, this);
+    d->librariesModel->setSelection(&d->selection);
+    d->libraries = new QListView();
+    d->libraries->setUniformItemSizes(true);
+    d->libraries->setModel(d->librariesModel);
+    l->addWidget(d->libraries);
   }
 
   {
@@ -462,20 +556,7 @@ MainWindow::MainWindow(Cache* cache):
     auto generateButton = new QPushButton("Generate");
     l->addWidget(generateButton, 0, Qt::AlignLeft);
 
-    connect(generateButton, &QPushButton::clicked, this, [&]
-    {
-      tp_qt_widgets::BlockingOperationDialog::exec(d->poll, "Updating the cache", this, [&](tp_utils::Progress* progress)
-      {
-        return generateApp(*d->cache,
-                           d->appTemplateName(),
-                           d->rootPath->text().toStdString(),
-                           d->modulePrefix->text().toStdString(),
-                           d->moduleSuffix->text().toStdString(),
-                           d->selectedLibraries(),
-                           d->allDependencies(),
-                           progress);
-      });
-    });
+    connect(generateButton, &QPushButton::clicked, this, [&]{d->generateClicked();});
 
     l->addStretch();
   }
@@ -0,0 +1,225 @@
+#include "general_configurator/ModuleListModel.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/LibrarySelection.h"
+#include "general_configurator_core/ModuleGraph.h"
+#include "general_configurator_core/ModuleSearchIndex.h"
+
+#include <QFont>
+
+#include <algorithm>
+
+namespace general_configurator
+{
+
+//##################################################################################################
+struct ModuleListModel::Private
+{
+  Q* q;
+  Cache* cache;
+  const std::vector<ModuleType> types;
+  LibrarySelection* selection{nullptr};
+  ModuleQuery query;
+
+  std::vector<uint32_t> ids;  //!< The module id of each row.
+  std::vector<int> rows;      //!< The row of each module id, -1 for modules that are not listed.
+
+  //################################################################################################
+  Private(Q* q_, Cache* cache_, const std::vector<ModuleType>& types_):
+    q(q_),
+    cache(cache_),
+    types(types_)
+  {
+    update();
+  }
+
+  //################################################################################################
+  void update()
+  {
+    const auto& graph = cache->graph();
+    ids.clear();
+    rows.assign(graph.size(), -1);
+
+    auto add = [&](uint32_t id)
+    {
+      if(tpContains(types, graph.type(id)))
+      {
+        rows[id] = int(ids.size());
+        ids.push_back(id);
+      }
+    };
+
+    if(query.empty())
+    {
+      for(uint32_t id=0; id<graph.size(); id++)
+        add(id);
+    }
+    else
+    {
+      for(auto id : cache->searchIndex().search(query))
+        add(id);
+    }
+  }
+};
+
+//##################################################################################################
+ModuleListModel::ModuleListModel(Cache* cache, const std::vector<ModuleType>& types, QObject* parent):
+  QAbstractListModel(parent),
+  d(new Private(this, cache, types))
+{
+
+}
+
+//##################################################################################################
+ModuleListModel::~ModuleListModel()
+{
+  delete d;
+}
+
+//##################################################################################################
+void ModuleListModel::setSelection(LibrarySelection* selection)
+{
+  d->selection = selection;
+  selectionReset();
+}
+
+//##################################################################################################
+void ModuleListModel::reset()
+{
+  beginResetModel();
+  d->update();
+  endResetModel();
+}
+
+//##################################################################################################
+void ModuleListModel::setQuery(const ModuleQuery& query)
+{
+  beginResetModel();
+  d->query = query;
+  d->update();
+  endResetModel();
+}
+
+//##################################################################################################
+void ModuleListModel::selectionReset()
+{
+  if(!d->ids.empty())
+    emit dataChanged(index(0), index(int(d->ids.size())-1), {Qt::CheckStateRole, Qt::FontRole});
+}
+
+//##################################################################################################
+void ModuleListModel::modulesChanged(std::vector<uint32_t> ids)
+{
+  std::vector<int> changedRows;
+  changedRows.reserve(ids.size());
+  for(auto id : ids)
+    if(id<d->rows.size() && d->rows[id]>=0)
+      changedRows.push_back(d->rows[id]);
+
+  std::sort(changedRows.begin(), changedRows.end());
+  changedRows.erase(std::unique(changedRows.begin(), changedRows.end()), changedRows.end());
+
+  for(size_t i=0; i<changedRows.size();)
+  {
+    size_t j=i+1;
+    while(j<changedRows.size() && changedRows[j]==changedRows[j-1]+1)
+      j++;
+
+    emit dataChanged(index(changedRows[i]), index(changedRows[j-1]), {Qt::CheckStateRole});
+    i=j;
+  }
+}
+
+//##################################################################################################
+uint32_t ModuleListModel::moduleID(const QModelIndex& index) const
+{
+  if(!index.isValid() || index.row()<0 || size_t(index.row())>=d->ids.size())
+    return ModuleGraph::invalidID;
+  return d->ids.at(size_t(index.row()));
+}
+
+//##################################################################################################
+QModelIndex ModuleListModel::moduleIndex(uint32_t id) const
+{
+  if(id>=d->rows.size() || d->rows[id]<0)
+    return QModelIndex();
+  return index(d->rows[id]);
+}
+
+//##################################################################################################
+int ModuleListModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid()?0:int(d->ids.size());
+}
+
+//##################################################################################################
+QVariant ModuleListModel::data(const QModelIndex& index, int role) const
+{
+  uint32_t id = moduleID(index);
+  if(id == ModuleGraph::invalidID)
+    return QVariant();
+
+  switch(role)
+  {
+  case Qt::DisplayRole:
+    return QString::fromStdString(d->cache->graph().name(id).toString());
+
+  case Qt::CheckStateRole:
+    if(!d->selection)
+      return QVariant();
+
+    switch(d->selection->state(id))
+    {
+    case LibrarySelection::State::Unchecked: return Qt::Unchecked;
+    case LibrarySelection::State::Partial:   return Qt::PartiallyChecked;
+    case LibrarySelection::State::Checked:   return Qt::Checked;
+    }
+    return QVariant();
+
+  case Qt::FontRole:
+    if(d->selection && d->selection->required(id))
+    {
+      QFont fnt;
+      fnt.setWeight(QFont::Bold);
+      return fnt;
+    }
+    return QVariant();
+
+  default:
+    return QVariant();
+  }
+}
+
+//##################################################################################################
+Qt::ItemFlags ModuleListModel::flags(const QModelIndex& index) const
+{
+  uint32_t id = moduleID(index);
+  if(id == ModuleGraph::invalidID)
+    return Qt::NoItemFlags;
+
+  Qt::ItemFlags f = Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemNeverHasChildren;
+
+  // Modules needed by the template can't be unchecked.
+  if(d->selection && !d->selection->required(id))
+    f |= Qt::ItemIsUserCheckable;
+
+  return f;
+}
+
+//##################################################################################################
+bool ModuleListModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+  uint32_t id = moduleID(index);
+  if(id == ModuleGraph::invalidID || role != Qt::CheckStateRole || !d->selection || d->selection->required(id))
+    return false;
+
+  std::vector<uint32_t> changed{id};
+  if(value.toInt() == Qt::Checked)
+    d->selection->check(id, &changed);
+  else
+    d->selection->uncheck(id, &changed);
+
+  modulesChanged(changed);
+  return true;
+}
+
+}
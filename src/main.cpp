@@ -1,9 +1,11 @@
 #include "general_configurator/MainWindow.h"
-#include "general_configurator/Cache.h"
+#include "general_configurator_core/Cache.h"
+#include "general_configurator_core/CommandLine.h"
 
 #include "tp_utils_filesystem/Globals.h"
 
 #include <QApplication>
+#include <QMessageBox>
 #include <QStandardPaths>
 
 using namespace general_configurator;
@@ -13,14 +15,24 @@ int main(int argc, char* argv[])
 {
   tp_utils_filesystem::init();
 
+  QCoreApplication::setOrganizationName("Tdp");
+  QCoreApplication::setApplicationName("Configurator");
+
+  std::string cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString();
+
+  // Subcommands run before the QApplication is created so that they work without a display.
+  if(isCommandLine(argc, argv))
+    return runCommandLine(argc, argv, cacheDirectory);
+
   QApplication app(argc, argv);
-  app.setOrganizationName("Tdp");
-  app.setApplicationName("Configurator");
 
-  general_configurator::Cache cache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString());
+  general_configurator::Cache cache(cacheDirectory);
 
   MainWindow mainWindow(&cache);
   mainWindow.showMaximized();
 
+  if(!cache.loadError().empty())
+    QMessageBox::warning(&mainWindow, "Cache", QString::fromStdString(cache.loadError()));
+
   return app.exec();
 }
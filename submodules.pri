@@ -8,4 +8,8 @@ SUBDIRS += tp_utils_filesystem
 SUBDIRS += tp_qt_utils
 SUBDIRS += tp_qt_widgets
 
+SUBDIRS += general_configurator/general_configurator_core
+SUBDIRS += general_configurator/general_configurator_cli
+SUBDIRS += general_configurator/general_configurator_benchmark
+SUBDIRS += general_configurator/general_configurator_tests
 SUBDIRS += general_configurator
@@ -3,18 +3,9 @@ TEMPLATE = app
 
 SOURCES += src/main.cpp
 
-HEADERS += inc/general_configurator/Globals.h
-SOURCES += src/Globals.cpp
-
-HEADERS += inc/general_configurator/Cache.h
-SOURCES += src/Cache.cpp
-
-HEADERS += inc/general_configurator/UpdateCache.h
-SOURCES += src/UpdateCache.cpp
-
-HEADERS += inc/general_configurator/Generate.h
-SOURCES += src/Generate.cpp
-
 HEADERS += inc/general_configurator/MainWindow.h
 SOURCES += src/MainWindow.cpp
 
+HEADERS += inc/general_configurator/ModuleListModel.h
+SOURCES += src/ModuleListModel.cpp
+